@@ -0,0 +1,64 @@
+#ifndef TANK_BATCHED_BRAIN_H
+#define TANK_BATCHED_BRAIN_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "brain.h"
+#include "compiled_network.h"
+
+
+namespace tank
+{
+
+/**
+ * Evaluates up to LANES different networks side by side, one network per SIMD lane.
+ *
+ * The networks are laid over a shared set of slots - the inputs, the bias and then the k-th computed neuron of
+ * every network in slot NUM_INPUTS + 1 + k - and activations are stored structure-of-arrays, LANES floats per slot.
+ * For every computed slot the links of all lanes are merged into one list of sources with a weight per lane, zero
+ * where a lane adds nothing at that point, so a slot is one multiply-add per source across all lanes followed by a
+ * vectorized sigmoid. The merge keeps the links of every lane in serialized order and one term per link, duplicate
+ * links included, so each lane adds up exactly what Brain adds up in the same order and the outputs match Brain bit
+ * for bit. Lanes reading the same source next share an entry.
+ */
+class BatchedBrain
+{
+public:
+    static const int LANES = 8;
+
+    /**
+     * Throws std::invalid_argument if there are more than LANES networks or one of them has more than NUM_INPUTS
+     * inputs.
+     */
+    explicit BatchedBrain(const std::vector<std::shared_ptr<const CompiledNetwork>>& networks);
+
+    int size() const { return m_num_lanes; }
+
+    /**
+     * Feeds inputs[lane] through the network in every lane and writes the track speeds to outputs[lane].
+     */
+    void update(const BrainInput* inputs, BrainOutput* outputs);
+
+private:
+    int m_num_lanes;
+    int m_num_slots;
+
+    // Sources of computed slot k are m_sources[m_source_offsets[k] .. m_source_offsets[k + 1])
+    std::vector<std::int32_t> m_source_offsets;
+    std::vector<std::int32_t> m_sources;
+
+    // LANES weights per source entry
+    std::vector<float> m_weights;
+
+    // NUM_OUTPUTS slots per lane, -1 where the network has fewer outputs
+    std::vector<std::int32_t> m_outputs;
+
+    // LANES activations per slot
+    std::vector<float> m_activations;
+};
+
+}
+
+#endif
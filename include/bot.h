@@ -0,0 +1,61 @@
+#ifndef TANK_BOT_H
+#define TANK_BOT_H
+
+#include "brain.h"
+#include "memory_map.h"
+#include "world.h"
+
+
+namespace tank
+{
+
+/**
+ * Port of Bot from web/app/bot.js without the drawing bits. The brain lives outside of the bot so that a whole
+ * group of bots can think at once: a frame is sense(), feeding the readings to the brain, then act().
+ */
+class Bot
+{
+public:
+    explicit Bot(const World& world);
+
+    /**
+     * Advances the bot by one frame using the given brain.
+     */
+    void update(Brain& brain, const World& world);
+
+    /**
+     * Reads the sensors and returns the brain input for this frame.
+     */
+    BrainInput sense(const World& world);
+
+    /**
+     * Turns and moves the bot according to the track speeds the brain came up with.
+     */
+    void act(const BrainOutput& track_speeds, const World& world);
+
+    void reset();
+
+    Vec2 position() const { return m_position; }
+    const MemoryMap& memory_map() const { return m_memory_map; }
+
+private:
+    SensorArray get_trans_sensors() const;
+    SensorDepths get_feeler_senses(const SensorArray& sensors) const;
+    BrainInput create_brain_input(const SensorDepths& collisions, const SensorDepths& feelers, bool collided) const;
+
+    void update_rotation(float left_track, float right_track);
+    void update_direction();
+    void update_position(float left_track, float right_track, float x_limit, float y_limit, bool collided);
+
+    MemoryMap m_memory_map;
+    Vec2 m_position;
+    float m_rotation;
+    Vec2 m_direction;
+
+    // Whether any sensor was within COLLISION_THRESHOLD during the last sense()
+    bool m_collided;
+};
+
+}
+
+#endif
@@ -0,0 +1,54 @@
+#ifndef TANK_BRAIN_H
+#define TANK_BRAIN_H
+
+#include <array>
+#include <memory>
+#include <vector>
+
+#include "compiled_network.h"
+#include "consts.h"
+#include "fast_sigmoid.h"
+#include "network.h"
+
+
+namespace tank
+{
+
+using BrainInput = std::array<float, NUM_INPUTS>;
+using BrainOutput = std::array<float, NUM_OUTPUTS>;
+
+
+/**
+ * Port of BotBrain from web/app/brain.js running on a compiled network. Neurons are updated once per frame in
+ * serialized order, so links coming from neurons later in the order (recurrent links) read the value from the
+ * previous frame. The compiled network is immutable and can be shared, the brain only owns the activations.
+ */
+class Brain
+{
+public:
+    explicit Brain(const NetworkDescription& network);
+    explicit Brain(std::shared_ptr<const CompiledNetwork> network);
+
+    /**
+     * Feeds the sensor readings through the network and returns the left and right track speeds.
+     */
+    BrainOutput update(const BrainInput& input);
+
+private:
+    std::shared_ptr<const CompiledNetwork> m_network;
+    std::vector<float> m_activations;
+};
+
+
+/**
+ * The steepened sigmoid used by the NEAT networks, the same approximation the batched brain uses so a network scores
+ * the same whichever path evaluates it.
+ */
+inline float activation_function(float value)
+{
+    return fast_sigmoid(value);
+}
+
+}
+
+#endif
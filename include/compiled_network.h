@@ -0,0 +1,60 @@
+#ifndef TANK_COMPILED_NETWORK_H
+#define TANK_COMPILED_NETWORK_H
+
+#include <cstdint>
+#include <vector>
+
+#include "network.h"
+
+
+namespace tank
+{
+
+/**
+ * A phenotype flattened into contiguous arrays. Neurons are addressed by their slot in evaluation order: the input
+ * neurons first, then the bias, then every computed neuron. The incoming links of computed neuron k live in
+ * links[link_offsets[k] .. link_offsets[k + 1]), with the source already resolved to a slot, so evaluation is a
+ * single linear sweep with no lookups.
+ *
+ * Evaluation order is the serialized order of the network, not a topological sort of its links. The browser
+ * updates neurons in serialized order, so a link from a neuron later in it reads that neuron's value from the
+ * previous frame. Sorting would change which links see the current frame, and with it the fitness a network gets
+ * here compared to the browser.
+ */
+struct CompiledNetwork
+{
+    struct Link
+    {
+        std::int32_t source;
+        float weight;
+    };
+
+    int num_neurons = 0;
+
+    // Leading input neurons, fed straight from the sensor readings
+    int num_inputs = 0;
+
+    // Slot of the bias neuron, or -1 if the network has none
+    int bias = -1;
+
+    // Slot of the first neuron whose value is computed from its links
+    int first_computed = 0;
+
+    // One entry per computed neuron plus the end of the last one
+    std::vector<std::int32_t> link_offsets;
+    std::vector<Link> links;
+
+    // Slots of the output neurons in serialized order
+    std::vector<std::int32_t> outputs;
+};
+
+
+/**
+ * Resolves every link of the network to neuron slots and lays the links out in evaluation order. Throws
+ * std::invalid_argument if a link references a neuron the network doesn't have.
+ */
+CompiledNetwork compile_network(const NetworkDescription& network);
+
+}
+
+#endif
@@ -0,0 +1,28 @@
+#ifndef TANK_COMPRESSION_H
+#define TANK_COMPRESSION_H
+
+#include <string>
+
+
+namespace tank
+{
+
+/**
+ * Compresses data into the gzip format at the highest level. Throws std::runtime_error if zlib fails.
+ */
+std::string gzip_compress(const std::string& data);
+
+/**
+ * True if the build links the brotli encoder.
+ */
+bool brotli_available();
+
+/**
+ * Compresses data with brotli at the highest quality. Throws std::runtime_error if brotli fails or is not
+ * available in this build.
+ */
+std::string brotli_compress(const std::string& data);
+
+}
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef TANK_CONSTS_H
+#define TANK_CONSTS_H
+
+#include <cmath>
+
+
+/**
+ * Simulation constants. These mirror web/app/consts.js and the canvas size in web/index.html, so a bot evaluated
+ * natively sees the same world as one evaluated in the browser.
+ */
+namespace tank
+{
+
+const float PI = 3.14159265358979f;
+
+const float MAX_ROTATION = 0.2f;
+const float ANGLE_OFFSET = -PI / 2;
+const int NUM_SENSORS = 5;
+const float SENSOR_RANGE = 47.0f;
+const float COLLISION_THRESHOLD = 0.24f;
+const int CELL_SIZE = 40;
+const int MAX_TICK = 127;
+const int TICK_INCREMENT = 15;
+const float BOT_START_X = 400.0f;
+const float BOT_START_Y = 400.0f;
+const int FAST_MODE_FRAMES_PER_EPOCH = 2000;
+
+const float WORLD_WIDTH = 1900.0f;
+const float WORLD_HEIGHT = 800.0f;
+
+// Brain input reported for a sensor that did not hit anything
+const float NO_COLLISION = -1.0f;
+
+// Two readings per sensor (collision depth, feeler) plus the collided flag
+const int NUM_INPUTS = NUM_SENSORS * 2 + 1;
+const int NUM_OUTPUTS = 2;
+
+}
+
+#endif
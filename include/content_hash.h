@@ -0,0 +1,38 @@
+#ifndef TANK_CONTENT_HASH_H
+#define TANK_CONTENT_HASH_H
+
+#include <cstdint>
+#include <string>
+
+
+namespace tank
+{
+
+const std::uint64_t CONTENT_HASH_SEED = 14695981039346656037ull;
+
+
+/**
+ * 64 bit FNV-1a hash of the given bytes. Cheap and good enough to tell apart contents that are cached by value, not
+ * meant to resist collisions crafted on purpose.
+ *
+ * Passing the hash of earlier bytes as the seed hashes several pieces as if they were one.
+ */
+inline std::uint64_t content_hash(const char* data, std::size_t size, std::uint64_t hash = CONTENT_HASH_SEED)
+{
+    for(std::size_t i = 0; i < size; ++i)
+    {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+
+inline std::uint64_t content_hash(const std::string& data)
+{
+    return content_hash(data.data(), data.size());
+}
+
+}
+
+#endif
@@ -0,0 +1,52 @@
+#ifndef TANK_EXECUTOR_H
+#define TANK_EXECUTOR_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+
+namespace tank
+{
+
+/**
+ * Runs posted jobs one at a time, in order, on its own thread. Used to keep long computations off the HTTP
+ * worker threads while still serializing access to state that is not thread safe, such as neat::GenAlg.
+ */
+class SerialExecutor
+{
+public:
+    using Job = std::function<void()>;
+
+    SerialExecutor();
+
+    /**
+     * Finishes the jobs already posted, then joins the thread.
+     */
+    ~SerialExecutor();
+
+    SerialExecutor(const SerialExecutor&) = delete;
+    SerialExecutor& operator=(const SerialExecutor&) = delete;
+
+    void post(Job job);
+
+    /**
+     * Number of jobs waiting to run, not counting the one that is running.
+     */
+    std::size_t pending() const;
+
+private:
+    void run();
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::deque<Job> m_jobs;
+    bool m_stop;
+    std::thread m_thread;
+};
+
+}
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef TANK_FILE_READER_H
+#define TANK_FILE_READER_H
+
+#include <cstddef>
+#include <string>
+
+
+namespace tank
+{
+
+/**
+ * A file opened for reading at any offset with pread. A file truncated while it is read gives a short read, where a
+ * memory mapping of it would raise SIGBUS and take the server down. Throws std::runtime_error if the file can not
+ * be opened.
+ */
+class FileReader
+{
+public:
+    explicit FileReader(const std::string& path);
+    ~FileReader();
+
+    FileReader(const FileReader&) = delete;
+    FileReader& operator=(const FileReader&) = delete;
+
+    /**
+     * Size of the file when it was opened.
+     */
+    std::size_t size() const { return m_size; }
+
+    /**
+     * Reads up to length bytes at offset into buffer, carrying on after short and interrupted reads. Returns the
+     * number of bytes read, fewer than length only at the end of the file. Throws std::runtime_error if reading
+     * fails.
+     */
+    std::size_t read(std::size_t offset, char* buffer, std::size_t length) const;
+
+private:
+    std::string m_path;
+    int m_fd;
+    std::size_t m_size;
+};
+
+}
+
+#endif
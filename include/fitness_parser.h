@@ -0,0 +1,21 @@
+#ifndef TANK_FITNESS_PARSER_H
+#define TANK_FITNESS_PARSER_H
+
+#include <cstddef>
+#include <vector>
+
+
+namespace tank
+{
+
+/**
+ * Reads a JSON array of numbers, the body of a /fitness request, straight into fitnesses without building a
+ * document. Values are appended, so a vector reserved for the population is filled without reallocating. Throws
+ * std::invalid_argument naming the offset of the first byte that is not part of a well formed array of finite
+ * numbers.
+ */
+void parse_fitnesses(const char* begin, const char* end, std::vector<double>& fitnesses);
+
+}
+
+#endif
@@ -0,0 +1,47 @@
+#ifndef TANK_GENOME_IMAGES_H
+#define TANK_GENOME_IMAGES_H
+
+#include <cstdint>
+#include <vector>
+
+#include <neatnet/genalg.h>
+
+#include "executor.h"
+#include "image_store.h"
+
+
+namespace tank
+{
+
+/**
+ * Draws the best genomes of the genetic algorithm into PNG images on a background thread and puts them into an
+ * image store. Each image slot remembers the content hash of the network it shows last, and a genome whose
+ * structure and weights did not change since is not drawn again.
+ */
+class GenomeImageRenderer
+{
+public:
+    /**
+     * Images go into the given store under slots counting from 1.
+     */
+    GenomeImageRenderer(ImageStore& store, int width, int height);
+
+    /**
+     * Queues the best genomes of the given genetic algorithm for drawing. Must be called from the thread that owns
+     * the genetic algorithm - only the phenotypes are handed over to the background thread.
+     */
+    void render(neat::GenAlg& ga);
+
+private:
+    ImageStore& m_store;
+    int m_width;
+    int m_height;
+    std::vector<std::uint64_t> m_slot_hashes;
+
+    // last, so queued drawings finish before anything else is torn down
+    SerialExecutor m_executor;
+};
+
+}
+
+#endif
@@ -0,0 +1,65 @@
+#ifndef TANK_IMAGE_STORE_H
+#define TANK_IMAGE_STORE_H
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+
+namespace tank
+{
+
+/**
+ * An encoded image together with the generation it was drawn in.
+ */
+struct StoredImage
+{
+    std::vector<unsigned char> bytes;
+    int generation;
+    std::string etag;
+};
+
+
+/**
+ * Encoded images kept in memory, so the server hands them out without going through the disk. Images are
+ * replaced as a whole, a reader holding on to one never sees it change.
+ */
+class ImageStore
+{
+public:
+    using Listener = std::function<void(int slot, const StoredImage& image)>;
+
+    ImageStore();
+
+    /**
+     * Called with every image put into the store, on the thread that puts it.
+     */
+    void set_listener(Listener listener);
+
+    void put(int slot, int generation, std::vector<unsigned char> bytes);
+
+    /**
+     * The image in the given slot, or nullptr if nothing was drawn there yet.
+     */
+    std::shared_ptr<const StoredImage> get(int slot) const;
+
+    /**
+     * Slot numbers that hold an image, in increasing order.
+     */
+    std::vector<int> slots() const;
+
+private:
+    // tells apart the ETags of different runs, which count generations from the same start
+    std::string m_run_tag;
+
+    mutable std::mutex m_mutex;
+    Listener m_listener;
+    std::map<int, std::shared_ptr<const StoredImage>> m_images;
+};
+
+}
+
+#endif
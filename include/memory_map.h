@@ -0,0 +1,51 @@
+#ifndef TANK_MEMORY_MAP_H
+#define TANK_MEMORY_MAP_H
+
+#include <cstdint>
+#include <vector>
+
+
+namespace tank
+{
+
+/**
+ * Port of Map from web/app/map.js. The world is split into square cells and every frame the cell under the bot
+ * gains ticks up to MAX_TICK. The number of cells visited is the bot's fitness.
+ *
+ * Ticks never exceed MAX_TICK, so a cell is a single byte, and a cell counts as visited as soon as its ticks are
+ * non-zero. The visited count is kept up to date on the first touch of a cell, which makes the fitness O(1).
+ */
+class MemoryMap
+{
+public:
+    MemoryMap(float width, float height, int cell_size);
+
+    void update(float x_pos, float y_pos);
+
+    /**
+     * Ticks accumulated in the cell under the given position, MAX_TICK outside of the map.
+     */
+    int ticks_lingered(float x_pos, float y_pos) const;
+
+    int get_num_cells_visited() const { return m_num_cells_visited; }
+
+    void reset();
+
+private:
+    /**
+     * Index of the cell under the given position, or -1 if the position is outside of the map.
+     */
+    int cell_index(float x_pos, float y_pos) const;
+
+    float m_width;
+    float m_height;
+    int m_cell_size;
+    int m_num_cells_x;
+    int m_num_cells_y;
+    std::vector<std::uint8_t> m_ticks;
+    int m_num_cells_visited;
+};
+
+}
+
+#endif
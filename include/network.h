@@ -0,0 +1,57 @@
+#ifndef TANK_NETWORK_H
+#define TANK_NETWORK_H
+
+#include <vector>
+
+#include "json.hpp"
+
+
+namespace tank
+{
+
+enum class NeuronType
+{
+    INPUT,
+    BIAS,
+    HIDDEN,
+    OUTPUT
+};
+
+
+struct LinkDescription
+{
+    int input_id;
+    int output_id;
+    double weight;
+};
+
+
+struct NeuronDescription
+{
+    int id;
+    NeuronType type;
+    double activation_response;
+    std::vector<LinkDescription> in_links;
+};
+
+
+/**
+ * Plain copy of a phenotype as emitted by neat::NeuralNet::serialize(). Neurons are kept in serialized order, which
+ * is also the order the browser evaluates them in.
+ */
+using NetworkDescription = std::vector<NeuronDescription>;
+
+
+/**
+ * Builds a network description out of the JSON produced by neat::NeuralNet::serialize().
+ */
+NetworkDescription parse_network(const nlohmann::json& net);
+
+/**
+ * Bytes of memory a network description takes up, allocations included.
+ */
+std::size_t memory_usage(const NetworkDescription& network);
+
+}
+
+#endif
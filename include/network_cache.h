@@ -0,0 +1,91 @@
+#ifndef TANK_NETWORK_CACHE_H
+#define TANK_NETWORK_CACHE_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "network.h"
+
+
+namespace tank
+{
+
+/**
+ * A network together with its wire format and JSON encodings, each made the first time it is asked for.
+ */
+class CachedNetwork
+{
+public:
+    explicit CachedNetwork(NetworkDescription network);
+
+    const NetworkDescription& network() const { return m_network; }
+
+    /**
+     * The network as it appears in the networks of a wire format message, see wire_format.h.
+     */
+    const std::string& wire();
+
+    /**
+     * The network as it appears in the JSON the browser reads.
+     */
+    const std::string& json();
+
+    std::size_t memory_usage() const;
+
+private:
+    NetworkDescription m_network;
+    std::string m_wire;
+    std::string m_json;
+};
+
+
+using CachedNetworks = std::vector<std::shared_ptr<CachedNetwork>>;
+
+
+/**
+ * Encodings of networks kept across generations, keyed by a hash of their contents. Genomes carried over unchanged
+ * by an epoch, and every network of a generation that is handed out more than once, are encoded only once.
+ *
+ * NeatNet hands out phenotypes without the id of the genome behind them, so a network is recognised by what it is
+ * rather than where it came from. That also catches offspring identical to a parent.
+ */
+class NetworkCache
+{
+public:
+    /**
+     * Networks not seen for more than max_idle_generations generations are dropped.
+     */
+    explicit NetworkCache(int max_idle_generations = 1);
+
+    /**
+     * Cached networks for the given ones of a generation, in the same order. Only networks not seen before are
+     * copied.
+     */
+    CachedNetworks get(const std::vector<NetworkDescription>& networks, int generation);
+
+    std::size_t size() const { return m_entries.size(); }
+
+    void clear();
+
+    /**
+     * Bytes taken up by the cached networks and their encodings, shared with whoever else holds on to them.
+     */
+    std::size_t memory_usage() const;
+
+private:
+    struct Entry
+    {
+        std::shared_ptr<CachedNetwork> network;
+        int last_seen;
+    };
+
+    int m_max_idle_generations;
+    std::unordered_map<std::uint64_t, Entry> m_entries;
+};
+
+}
+
+#endif
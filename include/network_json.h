@@ -0,0 +1,32 @@
+#ifndef TANK_NETWORK_JSON_H
+#define TANK_NETWORK_JSON_H
+
+#include <string>
+#include <vector>
+
+#include "network.h"
+#include "network_cache.h"
+#include "wire_format.h"
+
+
+namespace tank
+{
+
+/**
+ * Writes networks as the JSON the browser reads, the layout of neat::NeuralNet::serialize(), straight from their
+ * descriptions without building a document. Outgoing links are rebuilt from the incoming ones.
+ *
+ * Like the wire format encoders these replace the contents of out but keep its capacity.
+ */
+void write_population_json(const CachedNetworks& networks, std::string& out);
+
+void write_generation_json(const GenerationSummary& summary, const CachedNetworks& networks, std::string& out);
+
+/**
+ * A single network, what the functions above put together from the encodings kept by the network cache.
+ */
+void write_network_json(const NetworkDescription& network, std::string& out);
+
+}
+
+#endif
@@ -0,0 +1,75 @@
+#ifndef TANK_OPTIONS_H
+#define TANK_OPTIONS_H
+
+#include <string>
+
+#include "consts.h"
+
+
+namespace tank
+{
+
+/**
+ * Command line options of the main executable.
+ */
+struct Options
+{
+    // Evolve without the browser using the native simulation
+    bool headless = false;
+    int generations = 100;
+    int frames = FAST_MODE_FRAMES_PER_EPOCH;
+
+    // Threads used to evaluate the population, 0 picks one per core
+    int sim_threads = 0;
+
+    // Port evaluation workers connect to in headless mode, 0 evaluates in this process
+    int workers_port = 0;
+
+    // Networks handed to a worker at a time, and seconds before a batch not back goes to another worker
+    int worker_batch = 64;
+    int worker_timeout = 30;
+
+    // Percentage of the networks back from the workers at which the batches still out go to free workers as well,
+    // 100 to only send them again after the timeout
+    int worker_resend = 100;
+
+    // Run as an evaluation worker of the coordinator at worker_host:worker_port instead
+    std::string worker_host;
+    int worker_port = 0;
+
+    // Serve static files gzip or brotli encoded with ETag revalidation instead of no-store
+    bool precompress = false;
+
+    int port = 8080;
+
+    // Port of the WebSocket observers connect to, 0 uses the one after the HTTP port
+    int push_port = 0;
+    bool no_push = false;
+
+    // Threads running the HTTP server, 0 picks one per core
+    int http_threads = 0;
+
+    // Seconds an idle keep-alive connection waits for its next request
+    int keepalive_timeout = 5;
+
+    // Requests in flight, from arrival until their response is sent, before new ones get 503, 0 for no limit
+    int max_connections = 0;
+
+    // Sessions running at once, the default one included, 0 for no limit
+    int max_sessions = 16;
+
+    // Megabytes a session started over /sessions may hold, its population included, before it is ended, 0 for no limit
+    int session_memory = 256;
+};
+
+
+/**
+ * Parses the command line, throws std::invalid_argument on unknown or malformed options.
+ */
+Options parse_options(int argc, const char* argv[]);
+
+std::string usage(const std::string& program);
+
+}
+
+#endif
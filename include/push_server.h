@@ -0,0 +1,67 @@
+#ifndef TANK_PUSH_SERVER_H
+#define TANK_PUSH_SERVER_H
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+
+namespace tank
+{
+
+/**
+ * WebSocket server that pushes run events to any number of observers. Messages are published under a topic and
+ * the latest message of every topic is kept, so an observer connecting mid-run gets the current state right away.
+ *
+ * Observers only listen - whatever they send is ignored. An observer that can not keep up never holds back the run
+ * or the other observers: its queue is replaced by the latest message of every topic, which brings it up to date.
+ */
+class PushServer
+{
+public:
+    /**
+     * Starts listening on the given port on a thread of its own. Throws boost::system::system_error if the port can
+     * not be bound.
+     */
+    PushServer(unsigned short port, std::size_t max_queued_messages = 8);
+    ~PushServer();
+
+    PushServer(const PushServer&) = delete;
+    PushServer& operator=(const PushServer&) = delete;
+
+    /**
+     * Sends a message to every connected observer and keeps it as the latest of its topic. Messages go out as text
+     * frames unless binary is set. Thread safe.
+     */
+    void publish(const std::string& topic, std::string message, bool binary = false);
+
+    /**
+     * Like publish, but observers connecting later get the snapshot instead of the message. Used when the message
+     * only makes sense to the observers that got the ones before, like a delta.
+     */
+    void publish(const std::string& topic, std::string message, std::string snapshot, bool binary);
+
+    using Payload = std::shared_ptr<const std::string>;
+
+    /**
+     * The same without copying the messages. The server holds on to them until every observer has them and a later
+     * message replaced the snapshot, they must not change while anyone else holds them.
+     */
+    void publish(const std::string& topic, Payload message, bool binary);
+    void publish(const std::string& topic, Payload message, Payload snapshot, bool binary);
+
+    std::size_t num_observers() const;
+
+    /**
+     * The port observers connect to, the one picked by the system if it was started on port 0.
+     */
+    unsigned short port() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> m_impl;
+};
+
+}
+
+#endif
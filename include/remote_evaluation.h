@@ -0,0 +1,82 @@
+#ifndef TANK_REMOTE_EVALUATION_H
+#define TANK_REMOTE_EVALUATION_H
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "network.h"
+#include "task_pool.h"
+#include "world.h"
+
+
+namespace tank
+{
+
+/**
+ * Hands the evaluation of networks out to worker processes connecting over TCP. Networks are split into batches,
+ * every worker simulates one batch at a time and answers with its fitnesses, see the evaluate and fitnesses
+ * messages in wire_format.h.
+ *
+ * Workers may come and go at any time. The batch of a worker that disconnects goes to the next free one, and so
+ * does a batch that is not back within the timeout - whichever answer arrives first is taken.
+ *
+ * NeatNet only breeds a whole generation at a time, so a slow worker holds up every epoch. With a resend share
+ * below 1, once that share of the networks is back the batches still out are sent to the workers that are free as
+ * well, without waiting for the timeout, and the first answer is taken. This only cuts the wait for stragglers, the
+ * epoch still waits for every network to be evaluated. The networks are shuffled into batches anew for every
+ * evaluation, so the same ones do not always end up last.
+ */
+class EvaluationCoordinator
+{
+public:
+    /**
+     * Starts listening on the given port on a thread of its own. Throws boost::system::system_error if the port can
+     * not be bound. The resend share is the share of networks, from 0 to 1, that has to be back before the batches
+     * still out are sent again, 1 to only send them again after the timeout.
+     */
+    EvaluationCoordinator(unsigned short port, std::size_t batch_size, std::chrono::milliseconds batch_timeout,
+                          double resend_share = 1.0);
+    ~EvaluationCoordinator();
+
+    EvaluationCoordinator(const EvaluationCoordinator&) = delete;
+    EvaluationCoordinator& operator=(const EvaluationCoordinator&) = delete;
+
+    /**
+     * Fitness of every network after the given number of frames, in order. Blocks until all of them are back, for
+     * as long as it takes a worker to connect.
+     */
+    std::vector<double> evaluate(const std::vector<NetworkDescription>& networks, int frames);
+
+    std::size_t num_workers() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> m_impl;
+};
+
+
+/**
+ * The other end of the coordinator: simulates the batches it gets in the given world on the task pool.
+ */
+class EvaluationWorker
+{
+public:
+    EvaluationWorker(World world, TaskPool& pool);
+
+    /**
+     * Serves the coordinator at host:port, connecting again whenever the connection drops. Only returns if the
+     * coordinator sends something that is not an evaluation request.
+     */
+    void run(const std::string& host, unsigned short port);
+
+private:
+    World m_world;
+    TaskPool& m_pool;
+};
+
+}
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef TANK_REQUEST_LIMITER_H
+#define TANK_REQUEST_LIMITER_H
+
+#include <atomic>
+#include <memory>
+
+
+namespace tank
+{
+
+/**
+ * Caps the number of requests handled at the same time. A request holds a ticket while it is handled, and once
+ * every ticket is out new requests are turned away instead of queuing up behind the busy ones.
+ */
+class RequestLimiter
+{
+public:
+    using Ticket = std::shared_ptr<void>;
+
+    /**
+     * 0 lets any number of requests in.
+     */
+    explicit RequestLimiter(unsigned max_requests);
+
+    RequestLimiter(const RequestLimiter&) = delete;
+    RequestLimiter& operator=(const RequestLimiter&) = delete;
+
+    /**
+     * A ticket that frees its slot when the last copy of it is dropped, or nullptr if all slots are taken.
+     */
+    Ticket try_acquire();
+
+    unsigned in_flight() const { return m_in_flight.load(); }
+
+private:
+    unsigned m_max_requests;
+    std::atomic<unsigned> m_in_flight;
+};
+
+}
+
+#endif
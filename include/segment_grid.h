@@ -0,0 +1,39 @@
+#ifndef TANK_SEGMENT_GRID_H
+#define TANK_SEGMENT_GRID_H
+
+#include <vector>
+
+#include "segment_set.h"
+#include "utils.h"
+
+
+namespace tank
+{
+
+/**
+ * Broad phase for the sensor raycasts. The world is split into square cells like Map does, and every cell keeps
+ * its own SegmentSet holding just the segments that pass within reach of the cell. Any ray of length up to reach
+ * that starts inside a cell can only hit segments of that cell, so a bot tests a handful of nearby edges no matter
+ * how many obstacles the map has.
+ */
+class SegmentGrid
+{
+public:
+    SegmentGrid() = default;
+    SegmentGrid(const std::vector<Polygon>& polygons, float width, float height, float cell_size, float reach);
+
+    /**
+     * Segments reachable from origin, or nullptr if origin is outside of the grid.
+     */
+    const SegmentSet* query(Vec2 origin) const;
+
+private:
+    float m_cell_size = 1.0f;
+    int m_num_cells_x = 0;
+    int m_num_cells_y = 0;
+    std::vector<SegmentSet> m_cells;
+};
+
+}
+
+#endif
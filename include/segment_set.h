@@ -0,0 +1,55 @@
+#ifndef TANK_SEGMENT_SET_H
+#define TANK_SEGMENT_SET_H
+
+#include <vector>
+
+#include "utils.h"
+
+
+namespace tank
+{
+
+/**
+ * Obstacle edges packed structure-of-arrays so sensor rays can be tested against a whole block of segments with
+ * one SIMD instruction per step of line_intersection_2d. Along with the end points every segment keeps its
+ * bounding box, which is what the first step of line_intersection_2d compares against, and the arrays are padded
+ * to a multiple of BLOCK with segments whose box can never overlap a ray.
+ */
+class SegmentSet
+{
+public:
+    static const int BLOCK = 8;
+
+    SegmentSet() = default;
+
+    /**
+     * Adds every edge of every polygon.
+     */
+    explicit SegmentSet(const std::vector<Polygon>& polygons);
+
+    void add(Vec2 c, Vec2 d);
+
+    std::size_t size() const { return m_size; }
+
+    /**
+     * Writes the nearest hit of each ray from origin to ends[s] as a fraction of the ray length, or NO_COLLISION.
+     * Produces the same values as running line_intersection_2d against every segment and keeping the smallest.
+     */
+    void cast(Vec2 origin, const SensorArray& ends, SensorDepths& depths) const;
+
+private:
+    std::size_t m_size = 0;
+
+    std::vector<float> m_x;
+    std::vector<float> m_y;
+    std::vector<float> m_dx;
+    std::vector<float> m_dy;
+    std::vector<float> m_min_x;
+    std::vector<float> m_max_x;
+    std::vector<float> m_min_y;
+    std::vector<float> m_max_y;
+};
+
+}
+
+#endif
@@ -0,0 +1,215 @@
+#ifndef TANK_SESSION_H
+#define TANK_SESSION_H
+
+#include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <neatnet/params.h>
+#include <neatnet/genalg.h>
+
+#include "executor.h"
+#include "genome_images.h"
+#include "json.hpp"
+#include "network_cache.h"
+#include "push_server.h"
+#include "wire_format.h"
+
+
+namespace tank
+{
+
+/**
+ * What a run is up to, readable without waiting on the epoch in progress.
+ */
+struct RunStatus
+{
+    std::mutex mutex;
+    int generation = 0;
+    double best_so_far = 0.0;
+    bool epoch_running = false;
+    std::size_t memory_usage = 0;
+};
+
+
+/**
+ * Output buffer of a message that is handed to the push server without copying it. A message is written into a
+ * buffer nobody else holds any more, so once there are enough of them to take turns, encoding and publishing a
+ * generation stops allocating.
+ */
+class SharedBuffer
+{
+public:
+    /**
+     * An empty buffer to write the next message into, it becomes the current one.
+     */
+    std::string& next();
+
+    const std::string& current() const;
+
+    /**
+     * The current message, not to be written to again while the push server holds it.
+     */
+    PushServer::Payload share() const { return m_current; }
+
+    std::size_t capacity() const;
+
+    /**
+     * Drops the buffers, the push server keeps the ones it still holds until it is done with them.
+     */
+    void release();
+
+private:
+    std::vector<std::shared_ptr<std::string>> m_buffers;
+    std::shared_ptr<std::string> m_current;
+};
+
+
+/**
+ * Output buffers reused from epoch to epoch, so serializing a generation stops allocating once they have grown to
+ * fit, and the encodings of the networks handed out.
+ */
+struct SerializationBuffers
+{
+    SharedBuffer full;
+    SharedBuffer delta;
+    std::string json;
+    NetworkCache networks;
+};
+
+
+/**
+ * One population evolving on its own, with its own parameters. Everything but the status is only touched by jobs
+ * posted through the session, which run one at a time on the compute executor all sessions share, so no two
+ * genetic algorithms ever run at once.
+ */
+struct Session : std::enable_shared_from_this<Session>
+{
+    Session(std::string id, const std::string& params_path, std::size_t population_size, std::size_t memory_budget,
+            SerialExecutor& compute);
+
+    Session(const Session&) = delete;
+    Session& operator=(const Session&) = delete;
+
+    /**
+     * Runs a job on the shared compute executor. The session is kept alive until the job has run.
+     */
+    void post(SerialExecutor::Job job);
+
+    /**
+     * Number of jobs of this session waiting to run, not counting the one that is running.
+     */
+    std::size_t pending() const { return m_pending; }
+
+    /**
+     * Bytes held by the population and by the networks and encodings kept for clients. The genetic algorithm does
+     * not tell how much it holds, it is counted as GA_COPIES copies of the networks of the current generation.
+     */
+    std::size_t memory_usage() const;
+
+    /**
+     * Measures the session after a job changed it. A session holding more than its budget is ended and
+     * on_over_budget is called, from then on ended() is true and its jobs are to be answered with an error.
+     */
+    void account_memory();
+
+    bool ended() const { return m_ended; }
+
+    // a genome and a phenotype per network of the population
+    static const std::size_t GA_COPIES = 2;
+
+    const std::string id;
+    const std::size_t population_size;
+
+    // bytes the session may hold, 0 for no limit
+    const std::size_t memory_budget;
+
+    neat::Params params;
+    neat::GenAlg ga;
+    GenerationHistory history;
+    SerializationBuffers buffers;
+    RunStatus status;
+
+    // observers and network images follow the default session only, nullptr for the others
+    PushServer* push = nullptr;
+    GenomeImageRenderer* images = nullptr;
+
+    // called on the compute executor with the id of the session once it goes over its budget
+    std::function<void(const std::string&)> on_over_budget;
+
+private:
+    SerialExecutor& m_compute;
+    std::atomic<std::size_t> m_pending;
+    std::atomic<bool> m_ended;
+};
+
+
+/**
+ * Sessions of the server by id, and the compute executor they share. A session removed here lives on until the last
+ * request using it lets go of it and its queued jobs have run, it is then destroyed on the executor too. Sessions
+ * must not outlive their manager.
+ */
+class SessionManager
+{
+public:
+    /**
+     * Sessions are created with the parameters in default_params_path, overridden by the ones they are created with.
+     * A session holding more than memory_budget bytes is ended, 0 for no limit.
+     */
+    SessionManager(std::string default_params_path, std::size_t max_sessions, std::size_t memory_budget);
+
+    /**
+     * Lets the jobs queued so far finish, then destroys the sessions.
+     */
+    ~SessionManager();
+
+    SessionManager(const SessionManager&) = delete;
+    SessionManager& operator=(const SessionManager&) = delete;
+
+    /**
+     * Creates a session with the given parameters replacing the defaults. An empty id picks an unused one. The
+     * population is built on the compute executor, after the jobs queued before. Throws std::invalid_argument for
+     * unknown parameters, values of another type than the default, negative values or values above the caps on
+     * the parameters sizing a population and its epochs, a population that would start out over the memory budget, or a taken id, and std::runtime_error once max_sessions are running.
+     * A session that is not limited, the one the server starts with from the operator's parameters, has no memory
+     * budget.
+     */
+    std::shared_ptr<Session> create(const std::string& id, const nlohmann::json& overrides, bool limited = true);
+
+    /**
+     * The session with the given id, or nullptr if there is none.
+     */
+    std::shared_ptr<Session> find(const std::string& id) const;
+
+    /**
+     * Returns false if there was no session with the given id.
+     */
+    bool remove(const std::string& id);
+
+    std::vector<std::shared_ptr<Session>> sessions() const;
+
+private:
+    /**
+     * Throws if a session with the given id can not be added, expects the lock to be held.
+     */
+    void check_can_add(const std::string& id) const;
+
+    std::string m_default_params_path;
+    std::size_t m_max_sessions;
+    std::size_t m_memory_budget;
+
+    mutable std::mutex m_mutex;
+    std::map<std::string, std::shared_ptr<Session>> m_sessions;
+    unsigned long m_next_id;
+
+    // declared last so it is destroyed first, it runs the deletions of the sessions while the map is still there
+    SerialExecutor m_compute;
+};
+
+}
+
+#endif
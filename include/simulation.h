@@ -0,0 +1,50 @@
+#ifndef TANK_SIMULATION_H
+#define TANK_SIMULATION_H
+
+#include <vector>
+
+#include "consts.h"
+#include "network.h"
+#include "task_pool.h"
+#include "world.h"
+
+
+namespace tank
+{
+
+/**
+ * Headless replacement for Game.fast_loop: drives one bot per network for a fixed number of frames and reports
+ * the number of cells each bot visited as its fitness. A population is split into groups of up to
+ * BatchedBrain::LANES bots that run in lockstep so their networks are evaluated together, and the groups are spread
+ * across the task pool. Groups shrink when there are too few of them for every thread of the pool to get one.
+ */
+class Simulation
+{
+public:
+    Simulation(World world, TaskPool& pool, int frames = FAST_MODE_FRAMES_PER_EPOCH);
+
+    std::vector<double> evaluate(const std::vector<NetworkDescription>& networks) const;
+
+    /**
+     * Runs a single network with the scalar Brain.
+     */
+    double evaluate(const NetworkDescription& network) const;
+
+    const World& world() const { return m_world; }
+
+    int frames() const { return m_frames; }
+
+private:
+    void evaluate_group(const std::vector<NetworkDescription>& networks,
+                        std::size_t begin,
+                        std::size_t end,
+                        std::vector<double>& fitnesses) const;
+
+    World m_world;
+    TaskPool& m_pool;
+    int m_frames;
+};
+
+}
+
+#endif
@@ -0,0 +1,113 @@
+#ifndef TANK_STATIC_FILE_CACHE_H
+#define TANK_STATIC_FILE_CACHE_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <ctime>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+namespace tank
+{
+
+/**
+ * One encoding of a cached file with the complete response headers to send it with.
+ */
+struct FileRepresentation
+{
+    // empty for the file as it is on disk, otherwise the Content-Encoding token
+    std::string encoding;
+    std::string etag;
+    std::string header;
+    std::string not_modified_header;
+    std::string body;
+};
+
+
+/**
+ * A file of the web root in every encoding it is served in. The unencoded representation always comes first.
+ */
+struct CachedFile
+{
+    std::vector<FileRepresentation> representations;
+    std::time_t last_write_time;
+    std::uintmax_t size;
+
+    /**
+     * The smallest representation allowed by the given Accept-Encoding header value, which may be nullptr when the
+     * request has none.
+     */
+    const FileRepresentation& select(const std::string* accept_encoding) const;
+};
+
+
+/**
+ * In-memory copy of the files under the web root, loaded at startup. Cached files are never modified, a file that
+ * changes on disk gets a new entry. A background thread compares modification times every refresh period, so
+ * serving a request never touches the filesystem. Files bigger than the size limit are left on disk.
+ *
+ * With precompression on, text files also get gzip and, when the build has it, brotli representations, built once
+ * when the file is loaded. Responses then carry strong ETags and ask clients to revalidate, instead of forbidding
+ * them to store anything.
+ */
+class StaticFileCache
+{
+public:
+    StaticFileCache(const std::string& root, std::uintmax_t max_file_size, bool precompress,
+                    std::chrono::milliseconds refresh_period = std::chrono::seconds(1));
+    ~StaticFileCache();
+
+    StaticFileCache(const StaticFileCache&) = delete;
+    StaticFileCache& operator=(const StaticFileCache&) = delete;
+
+    /**
+     * The file at the given request path, or nullptr if it is not cached. Directories resolve to their index.html,
+     * the query string is ignored.
+     */
+    std::shared_ptr<const CachedFile> find(const std::string& request_path) const;
+
+    /**
+     * Content type sent for the file at the given path, picked by its extension.
+     */
+    static std::string content_type(const std::string& path);
+
+    /**
+     * True if the If-None-Match header value lists the given ETag.
+     */
+    static bool etag_matches(const std::string& if_none_match, const std::string& etag);
+
+private:
+    using Files = std::map<std::string, std::shared_ptr<const CachedFile>>;
+
+    /**
+     * Scans the web root and reloads the files that are new or changed. Entries of unchanged files are reused.
+     */
+    void refresh();
+
+    void refresh_loop();
+
+    FileRepresentation make_representation(const std::string& key, std::string encoding, std::string body) const;
+
+    std::string m_root;
+    std::uintmax_t m_max_file_size;
+    bool m_precompress;
+    std::chrono::milliseconds m_refresh_period;
+
+    mutable std::mutex m_mutex;
+    std::shared_ptr<const Files> m_files;
+
+    std::mutex m_stop_mutex;
+    std::condition_variable m_stop_signal;
+    bool m_stop;
+    std::thread m_refresher;
+};
+
+}
+
+#endif
@@ -0,0 +1,68 @@
+#ifndef TANK_TASK_POOL_H
+#define TANK_TASK_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace tank
+{
+
+/**
+ * Fixed set of threads with one task queue each. A worker drains its own queue from the back and, once it runs
+ * dry, steals from the front of the other queues, so threads that got a batch of quick tasks keep busy with the
+ * leftovers of slower ones.
+ */
+class TaskPool
+{
+public:
+    explicit TaskPool(unsigned num_threads = default_thread_count());
+    ~TaskPool();
+
+    TaskPool(const TaskPool&) = delete;
+    TaskPool& operator=(const TaskPool&) = delete;
+
+    static unsigned default_thread_count();
+
+    unsigned size() const { return static_cast<unsigned>(m_threads.size()); }
+
+    /**
+     * Runs body(i) for every i in [0, count) across the pool and blocks until all of them finish. The calling
+     * thread steals work while it waits. The first exception thrown by body is rethrown here.
+     */
+    void parallel_for(std::size_t count, const std::function<void(std::size_t)>& body);
+
+private:
+    using Task = std::function<void()>;
+
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void worker_loop(unsigned index);
+
+    /**
+     * Pops a task from the queue at index, or steals one from another queue. Returns false if there is no work.
+     */
+    bool take_task(unsigned index, Task& task);
+
+    std::vector<std::unique_ptr<Queue>> m_queues;
+    std::vector<std::thread> m_threads;
+
+    std::mutex m_wake_mutex;
+    std::condition_variable m_wake;
+    std::atomic<long> m_pending;
+    bool m_stop;
+};
+
+}
+
+#endif
@@ -0,0 +1,67 @@
+#ifndef TANK_UTILS_H
+#define TANK_UTILS_H
+
+#include <algorithm>
+#include <array>
+#include <vector>
+
+#include "consts.h"
+
+
+namespace tank
+{
+
+struct Vec2
+{
+    float x;
+    float y;
+};
+
+// Closed polyline - the last point repeats the first one, same as in obstacles.js
+using Polygon = std::vector<Vec2>;
+using SensorArray = std::array<Vec2, NUM_SENSORS>;
+using SensorDepths = std::array<float, NUM_SENSORS>;
+
+
+template<typename T>
+inline T clamp(T value, T min_value, T max_value)
+{
+    return std::max(std::min(value, max_value), min_value);
+}
+
+
+/**
+ * Given 2 lines in 2D space - AB and CD this function calculates the distance along AB if intersection occurs
+ * between these lines. Otherwise returns NO_COLLISION. Port of utils.line_intersection_2d.
+ */
+inline float line_intersection_2d(Vec2 a, Vec2 b, Vec2 c, Vec2 d)
+{
+    // first check if lines intersect at all
+    if((a.y > d.y && b.y > d.y && a.y > c.y && b.y > c.y) ||
+       (b.y < c.y && a.y < c.y && b.y < d.y && a.y < d.y) ||
+       (a.x > d.x && b.x > d.x && a.x > c.x && b.x > c.x) ||
+       (b.x < c.x && a.x < c.x && b.x < d.x && a.x < d.x))
+    {
+        return NO_COLLISION;
+    }
+
+    float r_top = (a.y - c.y) * (d.x - c.x) - (a.x - c.x) * (d.y - c.y);
+    float r_bot = (b.x - a.x) * (d.y - c.y) - (b.y - a.y) * (d.x - c.x);
+
+    float s_top = (a.y - c.y) * (b.x - a.x) - (a.x - c.x) * (b.y - a.y);
+    float s_bot = r_bot;
+
+    float r_top_bot = r_top * r_bot;
+    float s_top_bot = s_top * s_bot;
+
+    if((r_top_bot > 0) && (r_top_bot < (r_bot * r_bot)) && (s_top_bot > 0) && (s_top_bot < (s_bot * s_bot)))
+    {
+        return r_top / r_bot;
+    }
+
+    return NO_COLLISION;
+}
+
+}
+
+#endif
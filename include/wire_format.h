@@ -0,0 +1,170 @@
+#ifndef TANK_WIRE_FORMAT_H
+#define TANK_WIRE_FORMAT_H
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "network.h"
+#include "network_cache.h"
+
+
+namespace tank
+{
+
+/**
+ * Compact binary encoding of the networks handed to the browser, decoded by web/app/wire.js. Every message starts
+ * with the magic "TNK", a version byte and a message kind:
+ *
+ *   population: varint generation, networks
+ *   generation: varint generation, zigzag best species id, f64 best fitness so far,
+ *               f64 species stats (mean, std, min, max, current),
+ *               varint species count, then zigzag id and f64 spawns per species,
+ *               networks
+ *
+ *   generation delta: the generation header, varint base generation, delta networks
+ *
+ *   networks:   varint count, then per network varint neuron count, and per neuron
+ *               u8 type, zigzag id, f32 activation response, varint link count,
+ *               then zigzag input id and f32 weight per incoming link
+ *
+ *   delta networks: varint count, then per network varint base network index + 1. A 0 is followed by the network
+ *               as above. Otherwise comes the varint neuron count and per neuron an u8 op and zigzag id:
+ *                 KEEP  - the neuron with that id in the base network, unchanged
+ *                 PATCH - the same, with f32 activation response, varint count of changed weights,
+ *                         then varint link index and f32 weight per change
+ *                 FULL  - a new or rewired neuron, u8 type, f32 activation response and its links as above
+ *
+ * Evaluation workers get and answer, each message preceded by its size as an u32:
+ *
+ *   evaluate:   varint batch id, varint frames to simulate, networks
+ *   fitnesses:  varint batch id, varint count, then f64 fitness per network
+ *
+ * Numbers are little endian. A link is only sent with the neuron it leads into, the decoder rebuilds the outgoing
+ * links from there.
+ */
+const std::string WIRE_CONTENT_TYPE = "application/x-tank-networks";
+const std::uint8_t WIRE_VERSION = 1;
+
+enum class WireMessage : std::uint8_t
+{
+    POPULATION = 1,
+    GENERATION = 2,
+    GENERATION_DELTA = 3,
+    EVALUATE = 4,
+    FITNESSES = 5
+};
+
+
+enum class DeltaOp : std::uint8_t
+{
+    KEEP = 0,
+    PATCH = 1,
+    FULL = 2
+};
+
+
+/**
+ * Everything the browser gets about a finished epoch besides the networks.
+ */
+struct GenerationSummary
+{
+    int generation = 0;
+    int best_species_id = 0;
+    double best_so_far = 0.0;
+
+    double stats_mean = 0.0;
+    double stats_std = 0.0;
+    double stats_min = 0.0;
+    double stats_max = 0.0;
+    double stats_current = 0.0;
+
+    // species id and the number of offspring it spawns
+    std::vector<std::pair<int, double>> species;
+};
+
+
+/**
+ * The encoders write into out, replacing what it held but keeping its capacity, so a buffer reused from epoch to
+ * epoch stops allocating once it has grown to fit.
+ */
+void encode_population(int generation, const CachedNetworks& networks, std::string& out);
+
+void encode_generation(const GenerationSummary& summary, const CachedNetworks& networks, std::string& out);
+
+/**
+ * A single network the way it appears in the networks of a message, what encode_population and encode_generation
+ * put together from the encodings kept by the network cache.
+ */
+void encode_network(const NetworkDescription& network, std::string& out);
+
+/**
+ * Encodes the networks as changes to the ones of an earlier generation the client already has. Each network is
+ * based on the earlier network sharing the most neurons with it - same id, type and inputs - and is sent whole if
+ * there is none.
+ */
+void encode_generation_delta(const GenerationSummary& summary, const std::vector<NetworkDescription>& networks,
+                             int base_generation, const std::vector<NetworkDescription>& base_networks,
+                             std::string& out);
+
+
+/**
+ * A batch of networks for an evaluation worker to simulate.
+ */
+struct EvaluationRequest
+{
+    std::uint64_t batch_id = 0;
+    int frames = 0;
+    std::vector<NetworkDescription> networks;
+};
+
+
+void encode_evaluation_request(std::uint64_t batch_id, int frames, const std::vector<NetworkDescription>& networks,
+                               std::string& out);
+
+void encode_fitnesses(std::uint64_t batch_id, const std::vector<double>& fitnesses, std::string& out);
+
+/**
+ * The decoders throw std::invalid_argument if the message is malformed or of another kind. Weights come back with
+ * the single precision they are sent in.
+ */
+EvaluationRequest decode_evaluation_request(const char* data, std::size_t size);
+
+std::vector<double> decode_fitnesses(const char* data, std::size_t size, std::uint64_t& batch_id);
+
+
+/**
+ * Networks of the last few generations handed out, the bases delta encoded generations can refer to.
+ */
+class GenerationHistory
+{
+public:
+    explicit GenerationHistory(std::size_t max_generations = 4);
+
+    /**
+     * Keeps the networks of a generation, replacing what was kept for it before.
+     */
+    void add(int generation, std::vector<NetworkDescription> networks);
+
+    /**
+     * Networks of the given generation, or nullptr if it is not kept anymore.
+     */
+    const std::vector<NetworkDescription>* find(int generation) const;
+
+    /**
+     * The generation added last and its networks, or nullptr if nothing was added yet.
+     */
+    const std::pair<int, std::vector<NetworkDescription>>* latest() const;
+
+    std::size_t memory_usage() const;
+
+private:
+    std::size_t m_max_generations;
+    std::deque<std::pair<int, std::vector<NetworkDescription>>> m_generations;
+};
+
+}
+
+#endif
@@ -0,0 +1,52 @@
+#ifndef TANK_WORLD_H
+#define TANK_WORLD_H
+
+#include <vector>
+
+#include "consts.h"
+#include "segment_grid.h"
+#include "segment_set.h"
+#include "utils.h"
+
+
+namespace tank
+{
+
+/**
+ * The arena bots drive around in: its dimensions and the obstacles the sensors can see.
+ */
+class World
+{
+public:
+    World(float width, float height, std::vector<Polygon> obstacles);
+
+    /**
+     * The arena defined in web/app/obstacles.js on the canvas from web/index.html.
+     */
+    static World default_world();
+
+    float width() const { return m_width; }
+    float height() const { return m_height; }
+    const std::vector<Polygon>& obstacles() const { return m_obstacles; }
+
+    /**
+     * Casts a ray from origin to every sensor end point and writes the nearest obstacle hit along each ray as a
+     * fraction of the ray length, or NO_COLLISION if the ray hits nothing.
+     *
+     * The browser keeps whichever hit it found last and stops scanning once every sensor has one; taking the
+     * nearest hit instead makes the result independent of obstacle order. Only the segments the grid cell under
+     * origin lists are tested, unless origin is off the map.
+     */
+    void cast_sensors(Vec2 origin, const SensorArray& ends, SensorDepths& depths) const;
+
+private:
+    float m_width;
+    float m_height;
+    std::vector<Polygon> m_obstacles;
+    SegmentSet m_segments;
+    SegmentGrid m_grid;
+};
+
+}
+
+#endif
@@ -0,0 +1,231 @@
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+#include "batched_brain.h"
+#include "fast_sigmoid.h"
+
+
+namespace tank
+{
+
+namespace
+{
+
+const int BIAS_SLOT = NUM_INPUTS;
+const int FIRST_COMPUTED_SLOT = NUM_INPUTS + 1;
+const int LANES = BatchedBrain::LANES;
+
+
+/**
+ * Slot shared by all lanes for the given slot of a single network.
+ */
+int shared_slot(const CompiledNetwork& net, int slot)
+{
+    if(slot < net.num_inputs)
+    {
+        return slot;
+    }
+    else if(slot == net.bias)
+    {
+        return BIAS_SLOT;
+    }
+    return FIRST_COMPUTED_SLOT + slot - net.first_computed;
+}
+
+
+/**
+ * The shared slot the most lanes read with their next link, the lowest one on a tie, or -1 once every lane has
+ * used up its links.
+ */
+int pick_source(const std::vector<std::shared_ptr<const CompiledNetwork>>& networks,
+                const std::int32_t* next,
+                const std::int32_t* end)
+{
+    int best = -1;
+    int best_votes = 0;
+    for(std::size_t lane = 0; lane < networks.size(); ++lane)
+    {
+        if(next[lane] >= end[lane])
+        {
+            continue;
+        }
+
+        int candidate = shared_slot(*networks[lane], networks[lane]->links[next[lane]].source);
+        int votes = 0;
+        for(std::size_t other = 0; other < networks.size(); ++other)
+        {
+            votes += next[other] < end[other] &&
+                     shared_slot(*networks[other], networks[other]->links[next[other]].source) == candidate;
+        }
+        if(votes > best_votes || (votes == best_votes && candidate < best))
+        {
+            best = candidate;
+            best_votes = votes;
+        }
+    }
+    return best;
+}
+
+
+/**
+ * Computes sigmoid(sum of weights * source activations) for all lanes of one slot.
+ */
+inline void update_slot(const float* weights, const std::int32_t* sources, std::int32_t count,
+                        const float* activations, float* out)
+{
+#if defined(__AVX2__)
+    __m256 sum = _mm256_setzero_ps();
+    for(std::int32_t e = 0; e < count; ++e)
+    {
+        __m256 weight = _mm256_loadu_ps(weights + e * LANES);
+        __m256 value = _mm256_loadu_ps(activations + sources[e] * LANES);
+        sum = _mm256_add_ps(sum, _mm256_mul_ps(weight, value));
+    }
+    _mm256_storeu_ps(out, fast_sigmoid(sum));
+#elif defined(__SSE2__)
+    __m128 low = _mm_setzero_ps();
+    __m128 high = _mm_setzero_ps();
+    for(std::int32_t e = 0; e < count; ++e)
+    {
+        const float* weight = weights + e * LANES;
+        const float* value = activations + sources[e] * LANES;
+        low = _mm_add_ps(low, _mm_mul_ps(_mm_loadu_ps(weight), _mm_loadu_ps(value)));
+        high = _mm_add_ps(high, _mm_mul_ps(_mm_loadu_ps(weight + 4), _mm_loadu_ps(value + 4)));
+    }
+    _mm_storeu_ps(out, fast_sigmoid(low));
+    _mm_storeu_ps(out + 4, fast_sigmoid(high));
+#else
+    float sum[LANES] = {};
+    for(std::int32_t e = 0; e < count; ++e)
+    {
+        const float* weight = weights + e * LANES;
+        const float* value = activations + sources[e] * LANES;
+        for(int lane = 0; lane < LANES; ++lane)
+        {
+            sum[lane] += weight[lane] * value[lane];
+        }
+    }
+    for(int lane = 0; lane < LANES; ++lane)
+    {
+        out[lane] = fast_sigmoid(sum[lane]);
+    }
+#endif
+}
+
+}
+
+
+BatchedBrain::BatchedBrain(const std::vector<std::shared_ptr<const CompiledNetwork>>& networks)
+    : m_num_lanes(static_cast<int>(networks.size())),
+      m_num_slots(FIRST_COMPUTED_SLOT),
+      m_outputs(LANES * NUM_OUTPUTS, -1)
+{
+    if(m_num_lanes > LANES)
+    {
+        throw std::invalid_argument("BatchedBrain holds at most " + std::to_string(LANES) + " networks");
+    }
+
+    int num_computed = 0;
+    for(auto& net : networks)
+    {
+        if(net->num_inputs > NUM_INPUTS)
+        {
+            throw std::invalid_argument("Network has more inputs than the bot provides");
+        }
+        num_computed = std::max(num_computed, net->num_neurons - net->first_computed);
+    }
+    m_num_slots += num_computed;
+
+    m_source_offsets.reserve(num_computed + 1);
+    for(int k = 0; k < num_computed; ++k)
+    {
+        // the next link of every lane into computed neuron k, and the end of them
+        std::int32_t next[LANES] = {};
+        std::int32_t end[LANES] = {};
+        for(int lane = 0; lane < m_num_lanes; ++lane)
+        {
+            auto& net = *networks[lane];
+            if(k < net.num_neurons - net.first_computed)
+            {
+                next[lane] = net.link_offsets[k];
+                end[lane] = net.link_offsets[k + 1];
+            }
+        }
+
+        m_source_offsets.push_back(static_cast<std::int32_t>(m_sources.size()));
+        while(true)
+        {
+            int source = pick_source(networks, next, end);
+            if(source < 0)
+            {
+                break;
+            }
+
+            // every lane reading that source next takes its link, the others add nothing
+            m_sources.push_back(source);
+            for(int lane = 0; lane < LANES; ++lane)
+            {
+                float weight = 0.0f;
+                if(lane < m_num_lanes && next[lane] < end[lane])
+                {
+                    auto& net = *networks[lane];
+                    auto& link = net.links[next[lane]];
+                    if(shared_slot(net, link.source) == source)
+                    {
+                        weight = link.weight;
+                        ++next[lane];
+                    }
+                }
+                m_weights.push_back(weight);
+            }
+        }
+    }
+    m_source_offsets.push_back(static_cast<std::int32_t>(m_sources.size()));
+
+    for(int lane = 0; lane < m_num_lanes; ++lane)
+    {
+        auto& net = *networks[lane];
+        for(std::size_t i = 0; i < net.outputs.size() && i < static_cast<std::size_t>(NUM_OUTPUTS); ++i)
+        {
+            m_outputs[lane * NUM_OUTPUTS + i] = shared_slot(net, net.outputs[i]);
+        }
+    }
+
+    m_activations.assign(m_num_slots * LANES, 0.0f);
+    std::fill_n(m_activations.begin() + BIAS_SLOT * LANES, LANES, 1.0f);
+}
+
+
+void BatchedBrain::update(const BrainInput* inputs, BrainOutput* outputs)
+{
+    float* activations = m_activations.data();
+    for(int lane = 0; lane < m_num_lanes; ++lane)
+    {
+        for(int i = 0; i < NUM_INPUTS; ++i)
+        {
+            activations[i * LANES + lane] = inputs[lane][i];
+        }
+    }
+
+    int num_computed = m_num_slots - FIRST_COMPUTED_SLOT;
+    for(int k = 0; k < num_computed; ++k)
+    {
+        update_slot(m_weights.data() + m_source_offsets[k] * LANES,
+                    m_sources.data() + m_source_offsets[k],
+                    m_source_offsets[k + 1] - m_source_offsets[k],
+                    activations,
+                    activations + (FIRST_COMPUTED_SLOT + k) * LANES);
+    }
+
+    for(int lane = 0; lane < m_num_lanes; ++lane)
+    {
+        for(int i = 0; i < NUM_OUTPUTS; ++i)
+        {
+            int slot = m_outputs[lane * NUM_OUTPUTS + i];
+            outputs[lane][i] = slot >= 0 ? activations[slot * LANES + lane] : 0.0f;
+        }
+    }
+}
+
+}
@@ -0,0 +1,152 @@
+#include <cmath>
+
+#include "bot.h"
+
+
+namespace tank
+{
+
+namespace
+{
+
+/**
+ * Sensor end points relative to a bot facing along the X axis. The browser rotates every sensor by ANGLE_OFFSET
+ * and then by the direction angle each frame, the first rotation is constant so it is folded in here.
+ */
+SensorArray create_sensors()
+{
+    SensorArray sensors;
+    float segment = PI / (NUM_SENSORS - 1);
+    for(int i = 0; i < NUM_SENSORS; ++i)
+    {
+        float x = -std::sin(i * segment + ANGLE_OFFSET) * SENSOR_RANGE;
+        float y = std::cos(i * segment + ANGLE_OFFSET) * SENSOR_RANGE;
+        sensors[i] = {x * std::cos(ANGLE_OFFSET) - y * std::sin(ANGLE_OFFSET),
+                      x * std::sin(ANGLE_OFFSET) + y * std::cos(ANGLE_OFFSET)};
+    }
+    return sensors;
+}
+
+const SensorArray SENSORS = create_sensors();
+
+}
+
+
+Bot::Bot(const World& world)
+    : m_memory_map(world.width(), world.height(), CELL_SIZE),
+      m_position{BOT_START_X, BOT_START_Y},
+      m_rotation(0.0f),
+      m_direction{-std::sin(m_rotation), std::cos(m_rotation)},
+      m_collided(false)
+{
+}
+
+
+void Bot::update(Brain& brain, const World& world)
+{
+    act(brain.update(sense(world)), world);
+}
+
+
+BrainInput Bot::sense(const World& world)
+{
+    auto trans_sensors = get_trans_sensors();
+
+    SensorDepths collisions;
+    world.cast_sensors(m_position, trans_sensors, collisions);
+    auto feelers = get_feeler_senses(trans_sensors);
+
+    m_collided = false;
+    for(float depth : collisions)
+    {
+        // arbitrarily chosen value - bots don't look terrible when stuck
+        m_collided |= depth != NO_COLLISION && depth < COLLISION_THRESHOLD;
+    }
+
+    return create_brain_input(collisions, feelers, m_collided);
+}
+
+
+void Bot::act(const BrainOutput& track_speeds, const World& world)
+{
+    float left = track_speeds[0];
+    float right = track_speeds[1];
+
+    update_rotation(left, right);
+    update_direction();
+    update_position(left, right, world.width(), world.height(), m_collided);
+}
+
+
+void Bot::reset()
+{
+    m_position = {BOT_START_X, BOT_START_Y};
+    m_memory_map.reset();
+}
+
+
+SensorArray Bot::get_trans_sensors() const
+{
+    // direction is a unit vector, so rotating by its angle is a complex multiplication
+    SensorArray trans_sensors;
+    for(int i = 0; i < NUM_SENSORS; ++i)
+    {
+        auto& sensor = SENSORS[i];
+        trans_sensors[i] = {sensor.x * m_direction.x - sensor.y * m_direction.y + m_position.x,
+                            sensor.x * m_direction.y + sensor.y * m_direction.x + m_position.y};
+    }
+    return trans_sensors;
+}
+
+
+SensorDepths Bot::get_feeler_senses(const SensorArray& sensors) const
+{
+    SensorDepths feelers;
+    for(int i = 0; i < NUM_SENSORS; ++i)
+    {
+        int ticks = m_memory_map.ticks_lingered(sensors[i].x, sensors[i].y) - MAX_TICK;
+        feelers[i] = static_cast<float>(ticks) / MAX_TICK;
+    }
+    return feelers;
+}
+
+
+BrainInput Bot::create_brain_input(const SensorDepths& collisions, const SensorDepths& feelers, bool collided) const
+{
+    BrainInput input;
+    for(int i = 0; i < NUM_SENSORS; ++i)
+    {
+        input[2 * i] = collisions[i];
+        input[2 * i + 1] = feelers[i];
+    }
+    input[NUM_INPUTS - 1] = collided ? 1.0f : 0.0f;
+    return input;
+}
+
+
+void Bot::update_rotation(float left_track, float right_track)
+{
+    m_rotation += clamp(left_track - right_track, -MAX_ROTATION, MAX_ROTATION);
+}
+
+
+void Bot::update_direction()
+{
+    // unit circle - cos -> X, sin -> Y
+    m_direction = {std::cos(m_rotation), std::sin(m_rotation)};
+}
+
+
+void Bot::update_position(float left_track, float right_track, float x_limit, float y_limit, bool collided)
+{
+    m_memory_map.update(m_position.x, m_position.y);
+
+    if(!collided)
+    {
+        float speed = left_track + right_track;
+        m_position.x = clamp(m_position.x + m_direction.x * speed, 0.0f, x_limit);
+        m_position.y = clamp(m_position.y + m_direction.y * speed, 0.0f, y_limit);
+    }
+}
+
+}
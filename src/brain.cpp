@@ -0,0 +1,56 @@
+#include <algorithm>
+
+#include "brain.h"
+
+
+namespace tank
+{
+
+Brain::Brain(const NetworkDescription& network)
+    : Brain(std::make_shared<const CompiledNetwork>(compile_network(network)))
+{
+}
+
+
+Brain::Brain(std::shared_ptr<const CompiledNetwork> network)
+    : m_network(std::move(network)),
+      m_activations(m_network->num_neurons, 0.0f)
+{
+}
+
+
+BrainOutput Brain::update(const BrainInput& input)
+{
+    auto& net = *m_network;
+    float* activations = m_activations.data();
+
+    int num_inputs = std::min(net.num_inputs, NUM_INPUTS);
+    std::copy(input.begin(), input.begin() + num_inputs, activations);
+
+    // set the bias neuron output to 1
+    if(net.bias >= 0)
+    {
+        activations[net.bias] = 1.0f;
+    }
+
+    const CompiledNetwork::Link* links = net.links.data();
+    const std::int32_t* offsets = net.link_offsets.data();
+    for(int slot = net.first_computed, k = 0; slot < net.num_neurons; ++slot, ++k)
+    {
+        float sum = 0.0f;
+        for(std::int32_t l = offsets[k]; l < offsets[k + 1]; ++l)
+        {
+            sum += links[l].weight * activations[links[l].source];
+        }
+        activations[slot] = activation_function(sum);
+    }
+
+    BrainOutput outputs{};
+    for(std::size_t i = 0; i < outputs.size() && i < net.outputs.size(); ++i)
+    {
+        outputs[i] = activations[net.outputs[i]];
+    }
+    return outputs;
+}
+
+}
@@ -0,0 +1,63 @@
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+
+#include "compiled_network.h"
+
+
+namespace tank
+{
+
+CompiledNetwork compile_network(const NetworkDescription& network)
+{
+    CompiledNetwork compiled;
+    compiled.num_neurons = static_cast<int>(network.size());
+
+    std::unordered_map<int, std::int32_t> slot_of;
+    std::size_t num_links = 0;
+    for(std::size_t i = 0; i < network.size(); ++i)
+    {
+        slot_of[network[i].id] = static_cast<std::int32_t>(i);
+        num_links += network[i].in_links.size();
+    }
+
+    while(compiled.num_inputs < compiled.num_neurons && network[compiled.num_inputs].type == NeuronType::INPUT)
+    {
+        ++compiled.num_inputs;
+    }
+
+    // the neuron right after the inputs is always driven to 1, same as in the browser
+    compiled.first_computed = compiled.num_inputs;
+    if(compiled.first_computed < compiled.num_neurons)
+    {
+        compiled.bias = compiled.first_computed++;
+    }
+
+    compiled.links.reserve(num_links);
+    compiled.link_offsets.reserve(compiled.num_neurons - compiled.first_computed + 1);
+    for(int slot = compiled.first_computed; slot < compiled.num_neurons; ++slot)
+    {
+        auto& neuron = network[slot];
+        compiled.link_offsets.push_back(static_cast<std::int32_t>(compiled.links.size()));
+        for(auto& link : neuron.in_links)
+        {
+            auto it = slot_of.find(link.input_id);
+            if(it == slot_of.end())
+            {
+                throw std::invalid_argument("Invalid network: Referenced neuron ID " + std::to_string(link.input_id) +
+                                            " doesn't have a neuron object.");
+            }
+            compiled.links.push_back({it->second, static_cast<float>(link.weight)});
+        }
+
+        if(neuron.type == NeuronType::OUTPUT)
+        {
+            compiled.outputs.push_back(slot);
+        }
+    }
+    compiled.link_offsets.push_back(static_cast<std::int32_t>(compiled.links.size()));
+
+    return compiled;
+}
+
+}
@@ -0,0 +1,75 @@
+#include <stdexcept>
+
+#include <zlib.h>
+#ifdef TANK_HAVE_BROTLI
+#include <brotli/encode.h>
+#endif
+
+#include "compression.h"
+
+
+namespace tank
+{
+
+std::string gzip_compress(const std::string& data)
+{
+    z_stream stream = {};
+    // 15 bits of window plus 16 selects the gzip wrapper instead of zlib's
+    if(deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED, 15 + 16, 9, Z_DEFAULT_STRATEGY) != Z_OK)
+    {
+        throw std::runtime_error("Could not initialize gzip compression");
+    }
+
+    std::string result(deflateBound(&stream, data.size()), '\0');
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+    stream.avail_in = static_cast<uInt>(data.size());
+    stream.next_out = reinterpret_cast<Bytef*>(&result[0]);
+    stream.avail_out = static_cast<uInt>(result.size());
+
+    int status = deflate(&stream, Z_FINISH);
+    result.resize(stream.total_out);
+    deflateEnd(&stream);
+
+    if(status != Z_STREAM_END)
+    {
+        throw std::runtime_error("gzip compression failed");
+    }
+    return result;
+}
+
+
+bool brotli_available()
+{
+#ifdef TANK_HAVE_BROTLI
+    return true;
+#else
+    return false;
+#endif
+}
+
+
+std::string brotli_compress(const std::string& data)
+{
+#ifdef TANK_HAVE_BROTLI
+    std::size_t size = BrotliEncoderMaxCompressedSize(data.size());
+    if(size == 0)
+    {
+        throw std::runtime_error("Input too large for brotli compression");
+    }
+
+    std::string result(size, '\0');
+    if(!BrotliEncoderCompress(BROTLI_MAX_QUALITY, BROTLI_DEFAULT_WINDOW, BROTLI_MODE_TEXT,
+                              data.size(), reinterpret_cast<const std::uint8_t*>(data.data()),
+                              &size, reinterpret_cast<std::uint8_t*>(&result[0])))
+    {
+        throw std::runtime_error("brotli compression failed");
+    }
+    result.resize(size);
+    return result;
+#else
+    (void)data;
+    throw std::runtime_error("Built without brotli support");
+#endif
+}
+
+}
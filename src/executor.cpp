@@ -0,0 +1,72 @@
+#include <exception>
+#include <iostream>
+
+#include "executor.h"
+
+
+namespace tank
+{
+
+SerialExecutor::SerialExecutor()
+    : m_stop(false),
+      m_thread(&SerialExecutor::run, this)
+{
+}
+
+
+SerialExecutor::~SerialExecutor()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_one();
+    m_thread.join();
+}
+
+
+void SerialExecutor::post(Job job)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_jobs.push_back(std::move(job));
+    }
+    m_wake.notify_one();
+}
+
+
+std::size_t SerialExecutor::pending() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_jobs.size();
+}
+
+
+void SerialExecutor::run()
+{
+    while(true)
+    {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [this]() { return m_stop || !m_jobs.empty(); });
+            if(m_jobs.empty())
+            {
+                return;
+            }
+            job = std::move(m_jobs.front());
+            m_jobs.pop_front();
+        }
+
+        try
+        {
+            job();
+        }
+        catch(const std::exception& e)
+        {
+            std::cerr << "Job failed: " << e.what() << std::endl;
+        }
+    }
+}
+
+}
@@ -0,0 +1,68 @@
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "file_reader.h"
+
+
+namespace tank
+{
+
+FileReader::FileReader(const std::string& path)
+    : m_path(path),
+      m_fd(::open(path.c_str(), O_RDONLY | O_CLOEXEC)),
+      m_size(0)
+{
+    if(m_fd < 0)
+    {
+        throw std::runtime_error("Could not open " + path + ": " + std::strerror(errno));
+    }
+
+    struct stat info;
+    if(::fstat(m_fd, &info) != 0)
+    {
+        int error = errno;
+        ::close(m_fd);
+        throw std::runtime_error("Could not stat " + path + ": " + std::strerror(error));
+    }
+    m_size = static_cast<std::size_t>(info.st_size);
+
+    // files are sent front to back, let the kernel read ahead aggressively
+    ::posix_fadvise(m_fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+}
+
+
+FileReader::~FileReader()
+{
+    ::close(m_fd);
+}
+
+
+std::size_t FileReader::read(std::size_t offset, char* buffer, std::size_t length) const
+{
+    std::size_t total = 0;
+    while(total < length)
+    {
+        ssize_t result = ::pread(m_fd, buffer + total, length - total, static_cast<off_t>(offset + total));
+        if(result < 0)
+        {
+            if(errno == EINTR)
+            {
+                continue;
+            }
+            throw std::runtime_error("Could not read " + m_path + ": " + std::strerror(errno));
+        }
+        if(result == 0)
+        {
+            break;
+        }
+        total += static_cast<std::size_t>(result);
+    }
+    return total;
+}
+
+}
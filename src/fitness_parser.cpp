@@ -0,0 +1,200 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+
+#include "fitness_parser.h"
+
+
+namespace tank
+{
+
+namespace
+{
+
+// JSON numbers longer than this are not something a fitness is sent as
+const std::size_t MAX_NUMBER_LENGTH = 64;
+
+// integers with up to this many digits convert to double exactly
+const int MAX_EXACT_DIGITS = 15;
+
+
+class FitnessReader
+{
+public:
+    FitnessReader(const char* begin, const char* end)
+        : m_begin(begin),
+          m_pos(begin),
+          m_end(end)
+    {
+    }
+
+    void skip_whitespace()
+    {
+        while(m_pos != m_end && (*m_pos == ' ' || *m_pos == '\t' || *m_pos == '\n' || *m_pos == '\r'))
+        {
+            ++m_pos;
+        }
+    }
+
+    bool at_end() const { return m_pos == m_end; }
+
+    char peek() const { return m_pos != m_end ? *m_pos : '\0'; }
+
+    void expect(char c)
+    {
+        if(peek() != c)
+        {
+            fail(std::string("expected '") + c + "'");
+        }
+        ++m_pos;
+    }
+
+    double number()
+    {
+        const char* start = m_pos;
+        bool negative = false;
+        if(peek() == '-')
+        {
+            negative = true;
+            ++m_pos;
+        }
+
+        std::uint64_t integer = 0;
+        int digits = 0;
+        if(peek() == '0')
+        {
+            ++m_pos;
+            digits = 1;
+        }
+        else
+        {
+            while(is_digit(peek()))
+            {
+                integer = integer * 10 + static_cast<std::uint64_t>(*m_pos++ - '0');
+                ++digits;
+            }
+        }
+
+        if(digits == 0)
+        {
+            fail("expected a number");
+        }
+
+        bool exact = digits <= MAX_EXACT_DIGITS;
+        if(peek() == '.')
+        {
+            ++m_pos;
+            exact = false;
+            if(!is_digit(peek()))
+            {
+                fail("expected a digit after the decimal point");
+            }
+            while(is_digit(peek()))
+            {
+                ++m_pos;
+            }
+        }
+
+        if(peek() == 'e' || peek() == 'E')
+        {
+            ++m_pos;
+            exact = false;
+            if(peek() == '+' || peek() == '-')
+            {
+                ++m_pos;
+            }
+            if(!is_digit(peek()))
+            {
+                fail("expected a digit in the exponent");
+            }
+            while(is_digit(peek()))
+            {
+                ++m_pos;
+            }
+        }
+
+        if(exact)
+        {
+            double value = static_cast<double>(integer);
+            return negative ? -value : value;
+        }
+
+        // the token is validated already, strtod only does the rounding - on a terminated copy, the body is not
+        std::size_t length = static_cast<std::size_t>(m_pos - start);
+        if(length > MAX_NUMBER_LENGTH)
+        {
+            m_pos = start;
+            fail("number too long");
+        }
+
+        char token[MAX_NUMBER_LENGTH + 1];
+        std::copy(start, m_pos, token);
+        token[length] = '\0';
+        double value = std::strtod(token, nullptr);
+
+        // 1e999 is valid JSON, but an infinite fitness would poison the epoch
+        if(!std::isfinite(value))
+        {
+            m_pos = start;
+            fail("number out of range");
+        }
+        return value;
+    }
+
+    [[noreturn]] void fail(const std::string& reason) const
+    {
+        throw std::invalid_argument("Invalid fitness array at byte " + std::to_string(m_pos - m_begin) + ": " +
+                                    reason);
+    }
+
+private:
+    static bool is_digit(char c) { return c >= '0' && c <= '9'; }
+
+    const char* m_begin;
+    const char* m_pos;
+    const char* m_end;
+};
+
+}
+
+
+void parse_fitnesses(const char* begin, const char* end, std::vector<double>& fitnesses)
+{
+    FitnessReader reader(begin, end);
+    reader.skip_whitespace();
+    reader.expect('[');
+    reader.skip_whitespace();
+
+    if(reader.peek() == ']')
+    {
+        reader.expect(']');
+    }
+    else
+    {
+        while(true)
+        {
+            reader.skip_whitespace();
+            fitnesses.push_back(reader.number());
+            reader.skip_whitespace();
+
+            if(reader.peek() == ',')
+            {
+                reader.expect(',');
+                continue;
+            }
+            reader.expect(']');
+            break;
+        }
+    }
+
+    reader.skip_whitespace();
+    if(!reader.at_end())
+    {
+        reader.fail("unexpected data after the array");
+    }
+}
+
+}
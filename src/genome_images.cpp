@@ -0,0 +1,58 @@
+#include <memory>
+#include <stdexcept>
+
+#include <opencv2/highgui/highgui.hpp>
+#include <neatnet/netvisualize.h>
+
+#include "content_hash.h"
+#include "genome_images.h"
+
+
+namespace tank
+{
+
+GenomeImageRenderer::GenomeImageRenderer(ImageStore& store, int width, int height)
+    : m_store(store),
+      m_width(width),
+      m_height(height)
+{
+}
+
+
+void GenomeImageRenderer::render(neat::GenAlg& ga)
+{
+    int generation = ga.Generation();
+    std::size_t slot = 0;
+    for(auto& bg : ga.BestGenomes())
+    {
+        auto nn = std::make_shared<neat::NeuralNet>(bg);
+
+        // the serialized phenotype covers every neuron, link and weight of the genome
+        std::uint64_t hash = content_hash(nn->serialize().dump());
+        if(slot >= m_slot_hashes.size())
+        {
+            m_slot_hashes.resize(slot + 1, 0);
+        }
+        else if(m_slot_hashes[slot] == hash)
+        {
+            ++slot;
+            continue;
+        }
+        m_slot_hashes[slot] = hash;
+
+        int image_slot = static_cast<int>(++slot);
+        m_executor.post([this, nn, image_slot, generation]()
+        {
+            auto img = neat::visualize_net(*nn, m_width, m_height, true);
+
+            std::vector<unsigned char> png;
+            if(!cv::imencode(".png", img, png))
+            {
+                throw std::runtime_error("could not encode image " + std::to_string(image_slot));
+            }
+            m_store.put(image_slot, generation, std::move(png));
+        });
+    }
+}
+
+}
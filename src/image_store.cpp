@@ -0,0 +1,66 @@
+#include <chrono>
+#include <sstream>
+
+#include "image_store.h"
+
+
+namespace tank
+{
+
+ImageStore::ImageStore()
+    : m_run_tag(std::to_string(std::chrono::system_clock::now().time_since_epoch().count()))
+{
+}
+
+
+void ImageStore::set_listener(Listener listener)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_listener = std::move(listener);
+}
+
+
+void ImageStore::put(int slot, int generation, std::vector<unsigned char> bytes)
+{
+    auto image = std::make_shared<StoredImage>();
+    image->bytes = std::move(bytes);
+    image->generation = generation;
+
+    std::stringstream ss;
+    ss << "\"" << m_run_tag << "-" << slot << "-" << generation << "\"";
+    image->etag = ss.str();
+
+    Listener listener;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_images[slot] = image;
+        listener = m_listener;
+    }
+
+    if(listener)
+    {
+        listener(slot, *image);
+    }
+}
+
+
+std::shared_ptr<const StoredImage> ImageStore::get(int slot) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_images.find(slot);
+    return it != m_images.end() ? it->second : nullptr;
+}
+
+
+std::vector<int> ImageStore::slots() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<int> result;
+    for(auto& entry : m_images)
+    {
+        result.push_back(entry.first);
+    }
+    return result;
+}
+
+}
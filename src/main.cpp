@@ -1,80 +1,289 @@
 #include <fstream>
 #include <map>
+#include <mutex>
 #include <string>
+#include <vector>
 
+#include <boost/algorithm/string/predicate.hpp>
 #include <boost/filesystem.hpp>
-#include <opencv2/highgui/highgui.hpp>
+#include <boost/system/system_error.hpp>
 #include "json.hpp"
 
 #include <simple-web-server/server_http.hpp>
 #include <neatnet/params.h>
 #include <neatnet/genalg.h>
-#include <neatnet/netvisualize.h>
+
+#include "executor.h"
+#include "file_reader.h"
+#include "fitness_parser.h"
+#include "genome_images.h"
+#include "image_store.h"
+#include "network_json.h"
+#include "options.h"
+#include "push_server.h"
+#include "remote_evaluation.h"
+#include "request_limiter.h"
+#include "session.h"
+#include "simulation.h"
+#include "static_file_cache.h"
+#include "wire_format.h"
 
 
 using HttpServer = SimpleWeb::Server<SimpleWeb::HTTP>;
 
 
 const std::string HEAD = "HTTP/1.1 ";
-const int NUM_INPUTS = 11;
-const int NUM_OUTPUTS = 2;
 const std::string BEST_NN_PATH = "./web/images/best_nn_";
 const int IMAGE_WIDTH = 330;
 const int IMAGE_HEIGHT = 250;
+const std::uintmax_t STATIC_CACHE_MAX_FILE_SIZE = 4 * 1024 * 1024;
+const std::string DEFAULT_SESSION = "default";
+const std::string SESSION_ID_PATTERN = "([A-Za-z0-9_-]{1,64})";
+
+// files not in the static cache are read and sent 128 KB at a time
+const std::size_t FILE_CHUNK_SIZE = 131072;
+
+
+/**
+ * A file on its way to a client, read chunk after chunk into the same buffer.
+ */
+struct FileTransfer
+{
+    explicit FileTransfer(const std::string& path)
+        : file(path),
+          length(0),
+          sent(0)
+    {
+    }
+
+    tank::FileReader file;
+    std::vector<char> buffer;
+
+    // Content-Length promised to the client and the bytes written so far
+    std::size_t length;
+    std::size_t sent;
+};
 
 
 //================== Function declarations ====================
-void default_resource_send(const HttpServer &server, const std::shared_ptr<HttpServer::Response> &response,
-                           const std::shared_ptr<std::ifstream> &ifs);
+void default_resource_send(const HttpServer& server, const std::shared_ptr<HttpServer::Response>& response,
+                           const std::shared_ptr<FileTransfer>& transfer, std::size_t length);
+
+void write_body(const std::shared_ptr<HttpServer::Response>& response, const std::string& content_type,
+                const std::string& body);
 
 void fitness_handler(std::shared_ptr<HttpServer::Response> response,
                      std::shared_ptr<HttpServer::Request> request,
-                     neat::GenAlg& ga);
+                     tank::Session& session);
 
 void init_brains_handler(std::shared_ptr<HttpServer::Response> response,
                          std::shared_ptr<HttpServer::Request> request,
-                         neat::GenAlg& ga);
+                         tank::Session& session);
+
+void status_handler(std::shared_ptr<HttpServer::Response> response,
+                    std::shared_ptr<HttpServer::Request> request,
+                    tank::Session& session);
+
+void create_session_handler(std::shared_ptr<HttpServer::Response> response,
+                            std::shared_ptr<HttpServer::Request> request,
+                            tank::SessionManager& sessions);
+
+void list_sessions_handler(std::shared_ptr<HttpServer::Response> response,
+                           std::shared_ptr<HttpServer::Request> request,
+                           tank::SessionManager& sessions);
 
-void default_resource_handler(HttpServer& server, std::shared_ptr<HttpServer::Response>& response,
+void delete_session_handler(std::shared_ptr<HttpServer::Response> response,
+                            std::shared_ptr<HttpServer::Request> request,
+                            tank::SessionManager& sessions);
+
+void default_resource_handler(HttpServer& server, const tank::StaticFileCache& files,
+                              std::shared_ptr<HttpServer::Response>& response,
                               std::shared_ptr<HttpServer::Request>& request);
 
+void image_handler(std::shared_ptr<HttpServer::Response> response,
+                   std::shared_ptr<HttpServer::Request> request,
+                   const tank::ImageStore& store);
+
+const std::string* find_header(const HttpServer::Request& request, const std::string& name);
+
+bool accepts_wire_format(const HttpServer::Request& request);
+
+bool answer_ended(const std::shared_ptr<HttpServer::Response>& response, const tank::Session& session);
+
+template<typename Handler>
+std::function<void(std::shared_ptr<HttpServer::Response>, std::shared_ptr<HttpServer::Request>)>
+limit_requests(tank::RequestLimiter& limiter, Handler handler);
+
+template<typename Handler>
+std::function<void(std::shared_ptr<HttpServer::Response>, std::shared_ptr<HttpServer::Request>)>
+with_session(tank::SessionManager& sessions, Handler handler);
+
+void print_epoch_stats(neat::GenAlg& ga);
+
+int run_headless(neat::GenAlg& ga, const tank::Options& options);
+
+int run_worker(const tank::Options& options);
+
 
 //================== Main ====================
 int main(int argc, const char* argv[])
 {
+    tank::Options options;
+    try
+    {
+        options = tank::parse_options(argc, argv);
+    }
+    catch(const std::invalid_argument& e)
+    {
+        std::cerr << e.what() << std::endl << tank::usage(argv[0]);
+        return 1;
+    }
+
+    if(!options.worker_host.empty())
+    {
+        return run_worker(options);
+    }
+
+    if(options.headless)
+    {
+        neat::Params p("params.json");
+        neat::GenAlg ga(tank::NUM_INPUTS, tank::NUM_OUTPUTS, p);
+        return run_headless(ga, options);
+    }
+
     HttpServer server;
-    server.config.port = 8080;
+    server.config.port = static_cast<unsigned short>(options.port);
+    server.config.num_threads = options.http_threads > 0 ? options.http_threads
+                                                        : tank::TaskPool::default_thread_count();
+    server.config.timeout_request = options.keepalive_timeout;
 
-    neat::Params p("params.json");
-    neat::GenAlg ga(NUM_INPUTS, NUM_OUTPUTS, p);
+    tank::RequestLimiter limiter(options.max_connections);
+
+    tank::StaticFileCache files("web", STATIC_CACHE_MAX_FILE_SIZE, options.precompress);
+
+    // Observers follow the run over a WebSocket without posting fitnesses themselves. The server runs without them
+    // if the port is taken, /status tells the observers whether and where to connect.
+    std::unique_ptr<tank::PushServer> push;
+    if(!options.no_push)
+    {
+        int push_port = options.push_port > 0 ? options.push_port : options.port + 1;
+        try
+        {
+            push.reset(new tank::PushServer(static_cast<unsigned short>(push_port)));
+        }
+        catch(const boost::system::system_error& e)
+        {
+            std::cerr << "Observers can not connect, could not listen on port " << push_port << ": " << e.what()
+                      << std::endl;
+        }
+    }
+
+    tank::ImageStore image_store;
+    if(push)
+    {
+        image_store.set_listener([&push](int slot, const tank::StoredImage& image)
+        {
+            nlohmann::json message;
+            message["type"] = "image";
+            message["slot"] = slot;
+            message["generation"] = image.generation;
+            push->publish("image_" + std::to_string(slot), message.dump());
+        });
+    }
+    tank::GenomeImageRenderer images(image_store, IMAGE_WIDTH, IMAGE_HEIGHT);
+
+    // Every session evolves its own population, their epochs take turns on one compute executor. The one the server
+    // starts with is what the routes without a session prefix and the observers follow, it runs on the operator's
+    // params.json and has no memory budget.
+    tank::SessionManager sessions("params.json", options.max_sessions,
+                                  static_cast<std::size_t>(options.session_memory) * 1024 * 1024);
+    std::shared_ptr<tank::Session> default_session;
+    try
+    {
+        default_session = sessions.create(DEFAULT_SESSION, nlohmann::json::object(), false);
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << "Could not start the default session: " << e.what() << std::endl;
+        return 1;
+    }
+    default_session->push = push.get();
+    default_session->images = &images;
 
     // Register request handlers here
-    server.resource["^/fitness$"]["POST"] = [&server, &ga](std::shared_ptr<HttpServer::Response> response,
-                                                           std::shared_ptr<HttpServer::Request> request)
+    server.resource["^/fitness$"]["POST"] = limit_requests(limiter, [&default_session](
+        std::shared_ptr<HttpServer::Response> response,
+        std::shared_ptr<HttpServer::Request> request)
     {
-        fitness_handler(response, request, ga);
+        fitness_handler(response, request, *default_session);
+    });
+
+    server.resource["^/init_brains$"]["GET"] = limit_requests(limiter, [&default_session](
+        std::shared_ptr<HttpServer::Response> response,
+        std::shared_ptr<HttpServer::Request> request)
+    {
+        init_brains_handler(response, request, *default_session);
+    });
+
+    server.resource["^/status$"]["GET"] = limit_requests(limiter, [&default_session](
+        std::shared_ptr<HttpServer::Response> response,
+        std::shared_ptr<HttpServer::Request> request)
+    {
+        status_handler(response, request, *default_session);
+    });
+
+    auto sessions_resource = [&sessions](std::shared_ptr<HttpServer::Response> response,
+                                         std::shared_ptr<HttpServer::Request> request)
+    {
+        list_sessions_handler(response, request, sessions);
+    };
+    server.resource["^/sessions$"]["GET"] = limit_requests(limiter, sessions_resource);
+
+    auto create_resource = [&sessions](std::shared_ptr<HttpServer::Response> response,
+                                       std::shared_ptr<HttpServer::Request> request)
+    {
+        create_session_handler(response, request, sessions);
     };
+    server.resource["^/sessions$"]["POST"] = limit_requests(limiter, create_resource);
 
-    server.resource["^/init_brains$"]["GET"] = [&ga](std::shared_ptr<HttpServer::Response> response,
-                                                     std::shared_ptr<HttpServer::Request> request)
+    auto delete_resource = [&sessions](std::shared_ptr<HttpServer::Response> response,
+                                       std::shared_ptr<HttpServer::Request> request)
     {
-        init_brains_handler(response, request, ga);
+        delete_session_handler(response, request, sessions);
     };
+    server.resource["^/sessions/" + SESSION_ID_PATTERN + "$"]["DELETE"] = limit_requests(limiter, delete_resource);
+
+    server.resource["^/sessions/" + SESSION_ID_PATTERN + "$"]["GET"] =
+        limit_requests(limiter, with_session(sessions, status_handler));
+    server.resource["^/sessions/" + SESSION_ID_PATTERN + "/fitness$"]["POST"] =
+        limit_requests(limiter, with_session(sessions, fitness_handler));
+    server.resource["^/sessions/" + SESSION_ID_PATTERN + "/init_brains$"]["GET"] =
+        limit_requests(limiter, with_session(sessions, init_brains_handler));
 
-    server.default_resource["GET"] = [&server](std::shared_ptr<HttpServer::Response> response,
-                                               std::shared_ptr<HttpServer::Request> request)
+    auto image_resource = [&server, &files, &image_store](std::shared_ptr<HttpServer::Response> response,
+                                                          std::shared_ptr<HttpServer::Request> request)
     {
-        default_resource_handler(server, response, request);
+        if(image_store.get(std::stoi(request->path_match[1])))
+        {
+            image_handler(response, request, image_store);
+        }
+        else
+        {
+            // nothing drawn in this run yet, the images of an earlier run may still be on disk
+            default_resource_handler(server, files, response, request);
+        }
     };
+    server.resource["^/images/best_nn_([0-9]{1,3})\\.png$"]["GET"] = limit_requests(limiter, image_resource);
 
-    std::thread server_thread([&server]()
+    server.default_resource["GET"] = limit_requests(limiter, [&server, &files](
+        std::shared_ptr<HttpServer::Response> response,
+        std::shared_ptr<HttpServer::Request> request)
     {
-        server.start();
+        default_resource_handler(server, files, response, request);
     });
 
-    std::this_thread::sleep_for(std::chrono::seconds(1));
-
-    server_thread.join();
+    // runs the io threads and returns once the server stops
+    server.start();
 
     return 0;
 }
@@ -82,13 +291,191 @@ int main(int argc, const char* argv[])
 
 //================== Function definitions ====================
 
+/**
+ * Wraps a request handler so it only runs while the limiter has a free slot, and answers 503 otherwise. The slot is
+ * held until the response goes out, for handlers that post a job that is when the job lets go of the response.
+ */
+template<typename Handler>
+std::function<void(std::shared_ptr<HttpServer::Response>, std::shared_ptr<HttpServer::Request>)>
+limit_requests(tank::RequestLimiter& limiter, Handler handler)
+{
+    return [&limiter, handler](std::shared_ptr<HttpServer::Response> response,
+                               std::shared_ptr<HttpServer::Request> request)
+    {
+        auto ticket = limiter.try_acquire();
+        if(!ticket)
+        {
+            std::string content = "Too many requests in flight";
+            *response << HEAD << "503 Service Unavailable\r\n"
+                      << "Retry-After: 1\r\n"
+                      << "Content-Length: " << content.length() << "\r\n\r\n"
+                      << content;
+            return;
+        }
+
+        // the server sends the response once the last copy of it is dropped, the handler gets copies that also
+        // keep the ticket
+        auto holder = std::make_shared<std::pair<std::shared_ptr<HttpServer::Response>, tank::RequestLimiter::Ticket>>(
+            response, std::move(ticket));
+        handler(std::shared_ptr<HttpServer::Response>(holder, response.get()), request);
+    };
+}
+
+
+/**
+ * Wraps a handler of a session, the one named by the first match of the path. Answers 404 if there is no such
+ * session. The session is kept alive while the handler runs, and by the jobs it posts until they have run.
+ */
+template<typename Handler>
+std::function<void(std::shared_ptr<HttpServer::Response>, std::shared_ptr<HttpServer::Request>)>
+with_session(tank::SessionManager& sessions, Handler handler)
+{
+    return [&sessions, handler](std::shared_ptr<HttpServer::Response> response,
+                                std::shared_ptr<HttpServer::Request> request)
+    {
+        auto session = sessions.find(request->path_match[1]);
+        if(!session)
+        {
+            std::string content = "No session " + std::string(request->path_match[1]);
+            *response << HEAD << "404 Not Found\r\nContent-Length: " << content.length() << "\r\n\r\n" << content;
+            return;
+        }
+        handler(response, request, *session);
+    };
+}
+
+
+/**
+ * Evaluates batches for a headless coordinator, see --workers-port. Runs until the coordinator sends something
+ * that is not an evaluation request.
+ */
+int run_worker(const tank::Options& options)
+{
+    tank::TaskPool pool(options.sim_threads > 0 ? options.sim_threads : tank::TaskPool::default_thread_count());
+    tank::EvaluationWorker worker(tank::World::default_world(), pool);
+    worker.run(options.worker_host, static_cast<unsigned short>(options.worker_port));
+    return 1;
+}
+
+
+/**
+ * Converts the phenotypes handed out by the genetic algorithm into descriptions the native simulation can run.
+ */
+template<typename Networks>
+std::vector<tank::NetworkDescription> describe_networks(Networks& nns)
+{
+    std::vector<tank::NetworkDescription> networks;
+    networks.reserve(nns.size());
+    for(auto& nn : nns)
+    {
+        networks.push_back(tank::parse_network(nn->serialize()));
+    }
+    return networks;
+}
+
+
+/**
+ * Evolves the population without the browser - every generation is evaluated by the native simulation.
+ */
+int run_headless(neat::GenAlg& ga, const tank::Options& options)
+{
+    tank::TaskPool pool(options.sim_threads > 0 ? options.sim_threads : tank::TaskPool::default_thread_count());
+    tank::Simulation simulation(tank::World::default_world(), pool, options.frames);
+
+    // with a workers port the simulation runs in the worker processes instead
+    std::unique_ptr<tank::EvaluationCoordinator> coordinator;
+    if(options.workers_port > 0)
+    {
+        coordinator.reset(new tank::EvaluationCoordinator(static_cast<unsigned short>(options.workers_port),
+                                                          options.worker_batch,
+                                                          std::chrono::seconds(options.worker_timeout),
+                                                          options.worker_resend / 100.0));
+    }
+
+    auto nns = ga.CreateNeuralNetworks();
+    for(int generation = 0; generation < options.generations; ++generation)
+    {
+        auto networks = describe_networks(nns);
+        auto fitnesses = coordinator ? coordinator->evaluate(networks, options.frames) : simulation.evaluate(networks);
+
+        double max_fitness = 0.0;
+        for(double fitness : fitnesses)
+        {
+            max_fitness = std::max(max_fitness, fitness);
+        }
+
+        std::cout << "Best fitness this epoch: " << max_fitness << std::endl;
+        std::cout << "Best ever fitness: " << ga.BestEverFitness() << std::endl;
+
+        nns = ga.Epoch(fitnesses);
+        print_epoch_stats(ga);
+    }
+
+    tank::ImageStore image_store;
+    {
+        tank::GenomeImageRenderer images(image_store, IMAGE_WIDTH, IMAGE_HEIGHT);
+        images.render(ga);
+    }
+
+    // there is no server to hand the images out, leave them where the web client looks for them
+    for(int slot : image_store.slots())
+    {
+        auto image = image_store.get(slot);
+        std::ofstream ofs(BEST_NN_PATH + std::to_string(slot) + ".png", std::ios::binary);
+        ofs.write(reinterpret_cast<const char*>(image->bytes.data()), image->bytes.size());
+    }
+    return 0;
+}
+
+
+/**
+ * Prints species statistics of the epoch that just completed.
+ */
+void print_epoch_stats(neat::GenAlg& ga)
+{
+    auto stats = ga.SpeciesStats();
+    std::cout << "Avg Species: " << stats.Mean()
+              << ", STD: " << stats.StandardDeviation()
+              << ", Min: " << stats.MinValue()
+              << ", Max: " << stats.MaxValue()
+              << ", Current: " << stats.LastValue()
+              << std::endl;
+
+    for(auto& specie : ga.GetSpecies())
+    {
+        std::cout << "Specie " << specie.ID() << " spawned "
+                  << specie.SpawnsRequired() << " no improvement "
+                  << specie.GensNoImprovement() << std::endl;
+    }
+}
+
+
 /**
  * All requests that are not defined explicitly are assumed to be file requests, and this handler fetches them.
+ * Files are answered from the static file cache, only the ones it does not hold are read from disk.
  */
 inline void default_resource_handler(HttpServer& server,
+                              const tank::StaticFileCache& files,
                               std::shared_ptr<HttpServer::Response>& response,
                               std::shared_ptr<HttpServer::Request>& request)
 {
+    auto cached = files.find(request->path);
+    if(cached)
+    {
+        auto& representation = cached->select(find_header(*request, "Accept-Encoding"));
+
+        auto if_none_match = find_header(*request, "If-None-Match");
+        if(if_none_match && tank::StaticFileCache::etag_matches(*if_none_match, representation.etag))
+        {
+            *response << representation.not_modified_header;
+            return;
+        }
+
+        *response << representation.header;
+        response->write(representation.body.data(), representation.body.size());
+        return;
+    }
+
     try
     {
         auto web_root_path = boost::filesystem::canonical("web");
@@ -105,22 +492,17 @@ inline void default_resource_handler(HttpServer& server,
             throw std::invalid_argument("file does not exist");
         }
 
-        auto ifs = std::make_shared<std::ifstream>();
-        ifs->open(path.string(), std::ifstream::in | std::ios::binary | std::ios::ate);
-
-        if(*ifs)
-        {
-            auto length = ifs->tellg();
-            ifs->seekg(0, std::ios::beg);
-            auto cache_control = "Cache-Control: no-cache, no-store, must_revalidate\r\nPragma: no-cache\r\nExpires: 0\r\n";
-
-            *response << "HTTP/1.1 200 OK\r\n" << cache_control << "Content-Length: " << length << "\r\n\r\n";
-            default_resource_send(server, response, ifs);
-        }
-        else
-        {
-            throw std::invalid_argument("could not read file");
-        }
+        // the first chunk is read before the header, a file that fits into it goes out exactly as it was read
+        auto transfer = std::make_shared<FileTransfer>(path.string());
+        transfer->buffer.resize(std::min(FILE_CHUNK_SIZE, transfer->file.size()));
+        std::size_t length = transfer->file.read(0, transfer->buffer.data(), transfer->buffer.size());
+        transfer->length = length < FILE_CHUNK_SIZE ? length : transfer->file.size();
+        auto cache_control = "Cache-Control: no-cache, no-store, must_revalidate\r\nPragma: no-cache\r\nExpires: 0\r\n";
+
+        *response << "HTTP/1.1 200 OK\r\n"
+                  << "Content-Type: " << tank::StaticFileCache::content_type(path.string()) << "\r\n"
+                  << cache_control << "Content-Length: " << transfer->length << "\r\n\r\n";
+        default_resource_send(server, response, transfer, length);
     }
     catch(const std::exception& e)
     {
@@ -133,154 +515,499 @@ inline void default_resource_handler(HttpServer& server,
 }
 
 
-void generate_best_genome_images(neat::GenAlg& ga)
+/**
+ * Serves a network image straight from memory. The ETag changes only when the image is drawn again, so a client
+ * revalidating an unchanged image gets a 304 without the body.
+ */
+void image_handler(std::shared_ptr<HttpServer::Response> response,
+                   std::shared_ptr<HttpServer::Request> request,
+                   const tank::ImageStore& store)
 {
-    int img_id = 1;
-    for(auto& bg : ga.BestGenomes())
+    auto image = store.get(std::stoi(request->path_match[1]));
+
+    auto if_none_match = find_header(*request, "If-None-Match");
+    if(if_none_match && *if_none_match == image->etag)
     {
-        neat::NeuralNet nn(bg);
-        auto img = neat::visualize_net(nn, IMAGE_WIDTH, IMAGE_HEIGHT, true);
+        *response << HEAD << "304 Not Modified\r\n"
+                  << "ETag: " << image->etag << "\r\n"
+                  << "Cache-Control: no-cache\r\n\r\n";
+        return;
+    }
+
+    *response << HEAD << "200 OK\r\n"
+              << "Content-Type: image/png\r\n"
+              << "ETag: " << image->etag << "\r\n"
+              << "Cache-Control: no-cache\r\n"
+              << "Content-Length: " << image->bytes.size() << "\r\n\r\n";
+    response->write(reinterpret_cast<const char*>(image->bytes.data()), image->bytes.size());
+}
 
-        std::stringstream ss;
-        ss << BEST_NN_PATH << img_id++ << ".png";
 
-        cv::imwrite(ss.str(), img);
+/**
+ * Value of the named request header, or nullptr if the request does not have it. Header names are case insensitive.
+ */
+const std::string* find_header(const HttpServer::Request& request, const std::string& name)
+{
+    for(auto& header : request.header)
+    {
+        if(boost::iequals(header.first, name))
+        {
+            return &header.second;
+        }
     }
+    return nullptr;
 }
 
+
 /**
- * Handles fitnesses coming from the client.
+ * Writes a 200 response with the given body. The body is copied once, into the response stream buffer the server
+ * sends from, and its buffer can be reused as soon as this returns.
+ */
+void write_body(const std::shared_ptr<HttpServer::Response>& response, const std::string& content_type,
+                const std::string& body)
+{
+    *response << HEAD << "200 OK\r\n"
+              << "Content-Type: " << content_type << "\r\n"
+              << "Vary: Accept\r\n"
+              << "Content-Length: " << body.size() << "\r\n\r\n";
+    response->write(body.data(), body.size());
+}
+
+
+/**
+ * True if the client asked for networks in the binary wire format rather than JSON.
+ */
+bool accepts_wire_format(const HttpServer::Request& request)
+{
+    auto accept = find_header(request, "Accept");
+    return accept && accept->find(tank::WIRE_CONTENT_TYPE) != std::string::npos;
+}
+
+
+/**
+ * Answers 410 to a job of a session that was ended for going over its memory budget, and returns true if it did.
+ */
+bool answer_ended(const std::shared_ptr<HttpServer::Response>& response, const tank::Session& session)
+{
+    if(!session.ended())
+    {
+        return false;
+    }
+    std::string content = "Session " + session.id + " was ended, it outgrew its memory budget of " +
+                          std::to_string(session.memory_budget / (1024 * 1024)) + " MB";
+    *response << HEAD << "410 Gone\r\nContent-Length: " << content.length() << "\r\n\r\n" << content;
+    return true;
+}
+
+
+/**
+ * Handles fitnesses coming from the client. The body is parsed right away, the epoch itself runs on the compute
+ * executor the sessions share. The server sends the response once the last reference to it is released, so the HTTP
+ * thread is free as soon as the job is posted.
  */
 void fitness_handler(std::shared_ptr<HttpServer::Response> response,
                      std::shared_ptr<HttpServer::Request> request,
-                     neat::GenAlg& ga)
+                     tank::Session& session)
 {
-    using json = nlohmann::json;
+    std::vector<double> fitnesses;
+    fitnesses.reserve(session.population_size);
     try
     {
-        std::string post_data = request->content.string();
-        json obj = json::parse(post_data);
-        std::vector<double> fitnesses;
+        // the body sits in one contiguous buffer, parse it in place
+        auto body = dynamic_cast<boost::asio::streambuf*>(request->content.rdbuf());
+        if(body)
+        {
+            auto data = boost::asio::buffer_cast<const char*>(body->data());
+            tank::parse_fitnesses(data, data + body->size(), fitnesses);
+        }
+        else
+        {
+            std::string post_data = request->content.string();
+            tank::parse_fitnesses(post_data.data(), post_data.data() + post_data.size(), fitnesses);
+        }
 
-        double max_fitness = 0.0;
-        for(double fitness : obj)
+        if(fitnesses.size() != session.population_size)
         {
-            max_fitness = std::max(max_fitness, fitness);
-            fitnesses.push_back(fitness);
+            throw std::invalid_argument("Expected " + std::to_string(session.population_size) + " fitnesses, got " +
+                                        std::to_string(fitnesses.size()));
         }
+    }
+    catch(std::exception& e)
+    {
+        std::cerr << "Didn't handle /fitness POST: " << e.what() << std::endl;
+        *response << HEAD << "400 Bad Request\r\nContent-Length: " << std::strlen(e.what()) << "\r\n\r\n" << e.what();
+        return;
+    }
 
-        std::cout << "Best fitness this epoch: " << max_fitness << std::endl;
-        std::cout << "Best ever fitness: " << ga.BestEverFitness() << std::endl;
+    bool binary = accepts_wire_format(*request);
 
-        auto nns = ga.Epoch(fitnesses);
-        auto stats = ga.SpeciesStats();
-        std::cout << "Avg Species: " << stats.Mean()
-                  << ", STD: " << stats.StandardDeviation()
-                  << ", Min: " << stats.MinValue()
-                  << ", Max: " << stats.MaxValue()
-                  << ", Current: " << stats.LastValue()
-                  << std::endl;
+    // the generation the client holds, so the new one can be sent as changes to it
+    int base_generation = -1;
+    auto base_header = find_header(*request, "X-Base-Generation");
+    if(base_header)
+    {
+        try
+        {
+            base_generation = std::stoi(*base_header);
+        }
+        catch(const std::exception&)
+        {
+        }
+    }
 
-        json message;
-        auto& species = ga.GetSpecies();
+    session.post([response, fitnesses, binary, base_generation, &session]()
+    {
+        if(answer_ended(response, session))
+        {
+            return;
+        }
 
-        std::unordered_map<std::string, double> species_counts;
-        for(auto& specie : species)
+        auto& ga = session.ga;
+        auto& history = session.history;
+        auto& buffers = session.buffers;
+        auto& status = session.status;
+        try
         {
-            std::cout << "Specie " << specie.ID() << " spawned "
-                      << specie.SpawnsRequired() << " no improvement "
-                      << specie.GensNoImprovement() << std::endl;
-            species_counts[std::to_string(specie.ID())] = specie.SpawnsRequired();
+            {
+                std::lock_guard<std::mutex> lock(status.mutex);
+                status.epoch_running = true;
+            }
+
+            double max_fitness = 0.0;
+            for(double fitness : fitnesses)
+            {
+                max_fitness = std::max(max_fitness, fitness);
+            }
+
+            std::cout << "Best fitness this epoch: " << max_fitness << std::endl;
+            std::cout << "Best ever fitness: " << ga.BestEverFitness() << std::endl;
+
+            auto nns = ga.Epoch(fitnesses);
+            print_epoch_stats(ga);
+
+            std::vector<tank::NetworkDescription> networks;
+            networks.reserve(nns.size());
+            for(auto& nn : nns)
+            {
+                networks.push_back(tank::parse_network(nn->serialize()));
+            }
+
+            if(session.images)
+            {
+                session.images->render(ga);
+            }
+            auto cached = buffers.networks.get(networks, ga.Generation());
+
+            tank::GenerationSummary summary;
+            summary.generation = ga.Generation();
+            summary.best_species_id = (int)ga.BestGenome().GetSpeciesID();
+            summary.best_so_far = ga.BestEverFitness();
+            std::cout << "Best species id: " << summary.best_species_id << std::endl;
+
+            auto stats = ga.SpeciesStats();
+            summary.stats_mean = stats.Mean();
+            summary.stats_std = stats.StandardDeviation();
+            summary.stats_min = stats.MinValue();
+            summary.stats_max = stats.MaxValue();
+            summary.stats_current = stats.LastValue();
+
+            for(auto& specie : ga.GetSpecies())
+            {
+                summary.species.emplace_back(specie.ID(), specie.SpawnsRequired());
+            }
+
+            tank::encode_generation(summary, cached, buffers.full.next());
+
+            // observers hold the generation published last, late joiners get the whole one
+            auto published = history.latest();
+            if(published && (session.push || (binary && published->first == base_generation)))
+            {
+                tank::encode_generation_delta(summary, networks, published->first, published->second,
+                                              buffers.delta.next());
+            }
+            if(session.push)
+            {
+                if(published)
+                {
+                    session.push->publish("generation", buffers.delta.share(), buffers.full.share(), true);
+                }
+                else
+                {
+                    session.push->publish("generation", buffers.full.share(), true);
+                }
+            }
+
+            if(binary)
+            {
+                auto base_networks = history.find(base_generation);
+                if(!base_networks)
+                {
+                    write_body(response, tank::WIRE_CONTENT_TYPE, buffers.full.current());
+                }
+                else if(published && published->first == base_generation)
+                {
+                    write_body(response, tank::WIRE_CONTENT_TYPE, buffers.delta.current());
+                }
+                else
+                {
+                    tank::encode_generation_delta(summary, networks, base_generation, *base_networks,
+                                                  buffers.delta.next());
+                    write_body(response, tank::WIRE_CONTENT_TYPE, buffers.delta.current());
+                }
+            }
+            else
+            {
+                tank::write_generation_json(summary, cached, buffers.json);
+                write_body(response, "application/json", buffers.json);
+            }
+            history.add(summary.generation, std::move(networks));
+
+            {
+                std::lock_guard<std::mutex> lock(status.mutex);
+                status.generation = ga.Generation();
+                status.best_so_far = ga.BestEverFitness();
+                status.epoch_running = false;
+            }
+            session.account_memory();
+        }
+        catch(std::exception& e)
+        {
+            std::cerr << "Didn't handle /fitness POST: " << e.what() << std::endl;
+            *response << HEAD << "400 Bad Request\r\nContent-Length: " << std::strlen(e.what()) << "\r\n\r\n" << e.what();
+
+            std::lock_guard<std::mutex> lock(status.mutex);
+            status.epoch_running = false;
         }
+    });
+}
+
 
-        json networks_list;
-        for(auto& nn : nns)
+void init_brains_handler(std::shared_ptr<HttpServer::Response> response,
+                         std::shared_ptr<HttpServer::Request> request,
+                         tank::Session& session)
+{
+    bool binary = accepts_wire_format(*request);
+    session.post([response, binary, &session]()
+    {
+        if(answer_ended(response, session))
         {
-            networks_list.push_back(nn->serialize());
+            return;
         }
 
-        generate_best_genome_images(ga);
+        auto& ga = session.ga;
+        auto& history = session.history;
+        auto& buffers = session.buffers;
+        try
+        {
+            // the population only changes in an epoch, after the first request the networks handed out are reused
+            int generation = ga.Generation();
+            auto latest = history.latest();
+            bool fresh = !latest || latest->first != generation;
+            if(fresh)
+            {
+                std::vector<tank::NetworkDescription> networks;
+                auto nns = ga.CreateNeuralNetworks();
+                networks.reserve(nns.size());
+                for(auto& nn : nns)
+                {
+                    networks.push_back(tank::parse_network(nn->serialize()));
+                }
+                history.add(generation, std::move(networks));
+                latest = history.latest();
+            }
+
+            auto cached = buffers.networks.get(latest->second, generation);
+            if(fresh || binary)
+            {
+                tank::encode_population(generation, cached, buffers.full.next());
+            }
+            if(fresh && session.push)
+            {
+                session.push->publish("generation", buffers.full.share(), true);
+            }
+
+            if(binary)
+            {
+                write_body(response, tank::WIRE_CONTENT_TYPE, buffers.full.current());
+            }
+            else
+            {
+                tank::write_population_json(cached, buffers.json);
+                write_body(response, "application/json", buffers.json);
+            }
+
+            session.account_memory();
+        }
+        catch(std::exception& e)
+        {
+            std::cerr << "Didn't handle /init_brains GET: " << e.what() << std::endl;
+            *response << HEAD << "400 Bad Request\r\nContent-Length: " << std::strlen(e.what()) << "\r\n\r\n" << e.what();
+        }
+    });
+}
+
+
+/**
+ * State of a session as reported by the status and session listing handlers.
+ */
+nlohmann::json describe_session(tank::Session& session)
+{
+    nlohmann::json message;
+    message["id"] = session.id;
+    message["population_size"] = session.population_size;
+    message["memory_budget"] = session.memory_budget;
+    message["queued_jobs"] = session.pending();
+
+    std::lock_guard<std::mutex> lock(session.status.mutex);
+    message["generation"] = session.status.generation;
+    message["best_so_far"] = session.status.best_so_far;
+    message["epoch_running"] = session.status.epoch_running;
+    message["memory_usage"] = session.status.memory_usage;
+    return message;
+}
 
-        int species_id = (int)ga.BestGenome().GetSpeciesID();
-        std::cout << "Best species id: " << species_id << std::endl;
 
-        json species_map(species_counts);
-        message["generation"] = ga.Generation();
-        message["best_specie_id"] = species_id;
-        message["brains"] = networks_list;
-        message["species"] = species_map;
-        message["best_so_far"] = ga.BestEverFitness();
+/**
+ * Reports the state of a session without touching its genetic algorithm, so it answers even mid-epoch.
+ */
+void status_handler(std::shared_ptr<HttpServer::Response> response,
+                    std::shared_ptr<HttpServer::Request> request,
+                    tank::Session& session)
+{
+    auto message = describe_session(session);
+    if(session.push)
+    {
+        message["observers"] = session.push->num_observers();
+        message["push_port"] = session.push->port();
+    }
 
+    std::string result = message.dump();
 
-        std::string result = message.dump();
+    *response << HEAD << "200 OK\r\n"
+              << "Content-Type: application/json\r\n"
+              << "Content-Length: " << result.length() << "\r\n\r\n"
+              << result;
+}
+
+
+/**
+ * Starts a new session. The body is an optional JSON object of parameters replacing the ones in params.json.
+ */
+void create_session_handler(std::shared_ptr<HttpServer::Response> response,
+                            std::shared_ptr<HttpServer::Request> request,
+                            tank::SessionManager& sessions)
+{
+    try
+    {
+        std::string post_data = request->content.string();
+        auto overrides = post_data.empty() ? nlohmann::json::object() : nlohmann::json::parse(post_data);
+        auto session = sessions.create("", overrides);
 
-        *response << HEAD << "200 OK\r\n"
+        std::string result = describe_session(*session).dump();
+        *response << HEAD << "201 Created\r\n"
+                  << "Location: /sessions/" << session->id << "\r\n"
                   << "Content-Type: application/json\r\n"
                   << "Content-Length: " << result.length() << "\r\n\r\n"
                   << result;
     }
-    catch(std::exception& e)
+    catch(const std::runtime_error& e)
+    {
+        *response << HEAD << "503 Service Unavailable\r\nContent-Length: " << std::strlen(e.what()) << "\r\n\r\n"
+                  << e.what();
+    }
+    catch(const std::exception& e)
     {
-        std::cerr << "Didn't handle /fitness GET: " << e.what() << std::endl;
         *response << HEAD << "400 Bad Request\r\nContent-Length: " << std::strlen(e.what()) << "\r\n\r\n" << e.what();
     }
 }
 
 
-void init_brains_handler(std::shared_ptr<HttpServer::Response> response,
-                         std::shared_ptr<HttpServer::Request> request,
-                         neat::GenAlg& ga)
+void list_sessions_handler(std::shared_ptr<HttpServer::Response> response,
+                           std::shared_ptr<HttpServer::Request> request,
+                           tank::SessionManager& sessions)
 {
-    using json = nlohmann::json;
-    try
+    auto list = nlohmann::json::array();
+    for(auto& session : sessions.sessions())
     {
-        json list;
-        auto nns = ga.CreateNeuralNetworks();
-        for(auto& nn : nns)
-        {
-            list.push_back(nn->serialize());
-        }
+        list.push_back(describe_session(*session));
+    }
 
-        std::string result = list.dump();
+    std::string result = list.dump();
+    *response << HEAD << "200 OK\r\n"
+              << "Content-Type: application/json\r\n"
+              << "Content-Length: " << result.length() << "\r\n\r\n"
+              << result;
+}
 
-        *response << HEAD << "200 OK\r\n"
-                  << "Content-Type: application/json\r\n"
-                  << "Content-Length: " << result.length() << "\r\n\r\n"
-                  << result;
+
+/**
+ * Ends a session. Epochs already posted to it still finish and answer, the session goes away after them.
+ */
+void delete_session_handler(std::shared_ptr<HttpServer::Response> response,
+                            std::shared_ptr<HttpServer::Request> request,
+                            tank::SessionManager& sessions)
+{
+    std::string id = request->path_match[1];
+    if(id == DEFAULT_SESSION)
+    {
+        std::string content = "The default session can not be removed";
+        *response << HEAD << "400 Bad Request\r\nContent-Length: " << content.length() << "\r\n\r\n" << content;
+        return;
     }
-    catch(std::exception& e)
+
+    if(!sessions.remove(id))
     {
-        std::cerr << "Didn't handle /init_brains GET: " << e.what() << std::endl;
-        *response << HEAD << "400 Bad Request\r\nContent-Length: " << std::strlen(e.what()) << "\r\n\r\n" << e.what();
+        std::string content = "No session " + id;
+        *response << HEAD << "404 Not Found\r\nContent-Length: " << content.length() << "\r\n\r\n" << content;
+        return;
     }
+    *response << HEAD << "204 No Content\r\n\r\n";
 }
 
 
 /**
- * Send contents of input file stream to the client
+ * Send the length bytes in the buffer of the transfer to the client, then read and send the next chunk once they are
+ * out. A file that shrinks while it is sent ends the transfer short of its Content-Length.
  */
 void default_resource_send(const HttpServer& server,
                            const std::shared_ptr<HttpServer::Response>& response,
-                           const std::shared_ptr<std::ifstream>& ifs)
+                           const std::shared_ptr<FileTransfer>& transfer,
+                           std::size_t length)
 {
-    //read and send 128 KB at a time
-    std::shared_ptr<std::vector<char>> buffer = std::make_shared<std::vector<char>>(131072);
-    std::streamsize read_length;
-    if((read_length=ifs->read(&(*(buffer))[0], buffer->size()).gcount())>0)
+    response->write(transfer->buffer.data(), length);
+    transfer->sent += length;
+
+    if(transfer->sent < transfer->length)
     {
-        response->write(&(*(buffer))[0], read_length);
+        server.send(response,
+            [&server, response, transfer](const boost::system::error_code &ec)
+            {
+                if(ec)
+                {
+                    std::cerr << "Connection interrupted" << std::endl;
+                    return;
+                }
 
-        if(read_length == static_cast<std::streamsize>(buffer->size()))
-        {
-            server.send(response,
-                [&server, response, ifs](const boost::system::error_code &ec)
+                std::size_t length = 0;
+                try
                 {
-                    if(!ec)
-                        default_resource_send(server, response, ifs);
-                    else
-                        std::cerr << "Connection interrupted" << std::endl;
+                    length = transfer->file.read(transfer->sent, transfer->buffer.data(),
+                                                 std::min(transfer->buffer.size(), transfer->length - transfer->sent));
                 }
-            );
-        }
+                catch(const std::runtime_error& e)
+                {
+                    std::cerr << e.what() << std::endl;
+                    return;
+                }
+
+                if(length == 0)
+                {
+                    std::cerr << "File shrank while it was sent, " << transfer->length - transfer->sent
+                              << " bytes short" << std::endl;
+                    return;
+                }
+                default_resource_send(server, response, transfer, length);
+            }
+        );
     }
 }
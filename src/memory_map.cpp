@@ -0,0 +1,63 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "consts.h"
+#include "memory_map.h"
+
+
+namespace tank
+{
+
+MemoryMap::MemoryMap(float width, float height, int cell_size)
+    : m_width(width),
+      m_height(height),
+      m_cell_size(cell_size),
+      m_num_cells_x(static_cast<int>(std::floor(width / cell_size)) + 1),
+      m_num_cells_y(static_cast<int>(std::floor(height / cell_size)) + 1),
+      m_ticks(m_num_cells_x * m_num_cells_y, 0),
+      m_num_cells_visited(0)
+{
+    static_assert(MAX_TICK <= UINT8_MAX, "Ticks must fit into a byte");
+}
+
+
+void MemoryMap::update(float x_pos, float y_pos)
+{
+    int idx = cell_index(x_pos, y_pos);
+    if(idx >= 0)
+    {
+        auto& ticks = m_ticks[idx];
+        m_num_cells_visited += ticks == 0;
+        ticks = static_cast<std::uint8_t>(std::min(ticks + TICK_INCREMENT, MAX_TICK));
+    }
+}
+
+
+int MemoryMap::ticks_lingered(float x_pos, float y_pos) const
+{
+    int idx = cell_index(x_pos, y_pos);
+    return idx >= 0 ? m_ticks[idx] : MAX_TICK;
+}
+
+
+void MemoryMap::reset()
+{
+    std::memset(m_ticks.data(), 0, m_ticks.size());
+    m_num_cells_visited = 0;
+}
+
+
+int MemoryMap::cell_index(float x_pos, float y_pos) const
+{
+    if(!(x_pos >= 0 && x_pos <= m_width && y_pos >= 0 && y_pos <= m_height))
+    {
+        return -1;
+    }
+
+    int cellx = static_cast<int>(x_pos / m_cell_size);
+    int celly = static_cast<int>(y_pos / m_cell_size);
+    return cellx * m_num_cells_y + celly;
+}
+
+}
@@ -0,0 +1,72 @@
+#include <stdexcept>
+#include <string>
+
+#include "network.h"
+
+
+namespace tank
+{
+
+namespace
+{
+
+NeuronType parse_type(const std::string& type)
+{
+    if(type == "INPUT")
+    {
+        return NeuronType::INPUT;
+    }
+    else if(type == "BIAS")
+    {
+        return NeuronType::BIAS;
+    }
+    else if(type == "OUTPUT")
+    {
+        return NeuronType::OUTPUT;
+    }
+    return NeuronType::HIDDEN;
+}
+
+}
+
+
+NetworkDescription parse_network(const nlohmann::json& net)
+{
+    if(!net.is_array())
+    {
+        throw std::invalid_argument("Invalid network: expected an array of neurons");
+    }
+
+    NetworkDescription network;
+    network.reserve(net.size());
+    for(auto& neuron : net)
+    {
+        NeuronDescription desc;
+        desc.id = neuron["ID"].get<int>();
+        desc.type = parse_type(neuron["Type"].get<std::string>());
+        desc.activation_response = neuron["ActivationResponse"].get<double>();
+
+        for(auto& link : neuron["InLinks"])
+        {
+            desc.in_links.push_back({link["InputID"].get<int>(),
+                                     link["OutputID"].get<int>(),
+                                     link["Weight"].get<double>()});
+        }
+        network.push_back(std::move(desc));
+    }
+    return network;
+}
+
+
+
+std::size_t memory_usage(const NetworkDescription& network)
+{
+    std::size_t bytes = network.capacity() * sizeof(NeuronDescription);
+    for(auto& neuron : network)
+    {
+        bytes += neuron.in_links.capacity() * sizeof(LinkDescription);
+    }
+    return bytes;
+}
+
+}
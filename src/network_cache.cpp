@@ -0,0 +1,174 @@
+#include <algorithm>
+#include <cstring>
+
+#include "content_hash.h"
+#include "network_cache.h"
+#include "network_json.h"
+#include "wire_format.h"
+
+
+namespace tank
+{
+
+namespace
+{
+
+template<typename T>
+std::uint64_t hash_value(T value, std::uint64_t hash)
+{
+    char bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    return content_hash(bytes, sizeof(T), hash);
+}
+
+
+std::uint64_t network_hash(const NetworkDescription& network)
+{
+    std::uint64_t hash = CONTENT_HASH_SEED;
+    for(auto& neuron : network)
+    {
+        hash = hash_value(static_cast<int>(neuron.type), hash);
+        hash = hash_value(neuron.id, hash);
+        hash = hash_value(neuron.activation_response, hash);
+        hash = hash_value(neuron.in_links.size(), hash);
+        for(auto& link : neuron.in_links)
+        {
+            hash = hash_value(link.input_id, hash);
+            hash = hash_value(link.output_id, hash);
+            hash = hash_value(link.weight, hash);
+        }
+    }
+    return hash;
+}
+
+
+bool same_network(const NetworkDescription& a, const NetworkDescription& b)
+{
+    if(a.size() != b.size())
+    {
+        return false;
+    }
+
+    for(std::size_t n = 0; n < a.size(); ++n)
+    {
+        auto& x = a[n];
+        auto& y = b[n];
+        if(x.type != y.type || x.id != y.id || x.activation_response != y.activation_response ||
+           x.in_links.size() != y.in_links.size())
+        {
+            return false;
+        }
+
+        for(std::size_t l = 0; l < x.in_links.size(); ++l)
+        {
+            if(x.in_links[l].input_id != y.in_links[l].input_id ||
+               x.in_links[l].output_id != y.in_links[l].output_id ||
+               x.in_links[l].weight != y.in_links[l].weight)
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+}
+
+
+CachedNetwork::CachedNetwork(NetworkDescription network)
+    : m_network(std::move(network))
+{
+}
+
+
+const std::string& CachedNetwork::wire()
+{
+    if(m_wire.empty())
+    {
+        encode_network(m_network, m_wire);
+    }
+    return m_wire;
+}
+
+
+const std::string& CachedNetwork::json()
+{
+    if(m_json.empty())
+    {
+        write_network_json(m_network, m_json);
+    }
+    return m_json;
+}
+
+
+std::size_t CachedNetwork::memory_usage() const
+{
+    return sizeof(CachedNetwork) + tank::memory_usage(m_network) + m_wire.capacity() + m_json.capacity();
+}
+
+
+NetworkCache::NetworkCache(int max_idle_generations)
+    : m_max_idle_generations(max_idle_generations)
+{
+}
+
+
+CachedNetworks NetworkCache::get(const std::vector<NetworkDescription>& networks, int generation)
+{
+    CachedNetworks cached;
+    cached.reserve(networks.size());
+    for(auto& network : networks)
+    {
+        std::uint64_t hash = network_hash(network);
+        auto it = m_entries.find(hash);
+        if(it == m_entries.end())
+        {
+            auto entry = std::make_shared<CachedNetwork>(network);
+            m_entries.emplace(hash, Entry{entry, generation});
+            cached.push_back(std::move(entry));
+        }
+        else if(same_network(it->second.network->network(), network))
+        {
+            it->second.last_seen = std::max(it->second.last_seen, generation);
+            cached.push_back(it->second.network);
+        }
+        else
+        {
+            // a hash collision, the network is encoded but not kept
+            cached.push_back(std::make_shared<CachedNetwork>(network));
+        }
+    }
+
+    for(auto it = m_entries.begin(); it != m_entries.end();)
+    {
+        if(it->second.last_seen < generation - m_max_idle_generations)
+        {
+            it = m_entries.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+    return cached;
+}
+
+
+
+void NetworkCache::clear()
+{
+    m_entries.clear();
+}
+
+
+std::size_t NetworkCache::memory_usage() const
+{
+    std::size_t bytes = 0;
+    for(auto& entry : m_entries)
+    {
+        bytes += entry.second.network->memory_usage();
+    }
+    return bytes;
+}
+
+}
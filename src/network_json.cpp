@@ -0,0 +1,185 @@
+#include <cmath>
+#include <cstdio>
+#include <unordered_map>
+
+#include "network_json.h"
+
+
+namespace tank
+{
+
+namespace
+{
+
+const char* type_name(NeuronType type)
+{
+    switch(type)
+    {
+        case NeuronType::INPUT: return "INPUT";
+        case NeuronType::BIAS: return "BIAS";
+        case NeuronType::OUTPUT: return "OUTPUT";
+        default: return "HIDDEN";
+    }
+}
+
+
+class JsonWriter
+{
+public:
+    explicit JsonWriter(std::string& out)
+        : m_out(out)
+    {
+        m_out.clear();
+    }
+
+    JsonWriter& raw(const char* text)
+    {
+        m_out.append(text);
+        return *this;
+    }
+
+    JsonWriter& number(int value)
+    {
+        char buffer[16];
+        int length = std::snprintf(buffer, sizeof(buffer), "%d", value);
+        m_out.append(buffer, length);
+        return *this;
+    }
+
+    JsonWriter& number(double value)
+    {
+        // JSON has no infinities or NaNs, they go out as null like the json library writes them
+        if(!std::isfinite(value))
+        {
+            return raw("null");
+        }
+
+        char buffer[32];
+        int length = std::snprintf(buffer, sizeof(buffer), "%.17g", value);
+        m_out.append(buffer, length);
+        return *this;
+    }
+
+    void link(int input_id, int output_id, double weight)
+    {
+        raw("{\"InputID\":").number(input_id)
+            .raw(",\"OutputID\":").number(output_id)
+            .raw(",\"Weight\":").number(weight)
+            .raw("}");
+    }
+
+    void networks(const CachedNetworks& networks)
+    {
+        raw("[");
+        for(std::size_t n = 0; n < networks.size(); ++n)
+        {
+            if(n > 0)
+            {
+                raw(",");
+            }
+            m_out.append(networks[n]->json());
+        }
+        raw("]");
+    }
+
+    void network(const NetworkDescription& network)
+    {
+        // outgoing links of a neuron are the incoming links of others that name it as their input
+        m_out_links.clear();
+        for(auto& neuron : network)
+        {
+            for(auto& link : neuron.in_links)
+            {
+                m_out_links[link.input_id].push_back(&link);
+            }
+        }
+
+        raw("[");
+        for(std::size_t i = 0; i < network.size(); ++i)
+        {
+            auto& neuron = network[i];
+            if(i > 0)
+            {
+                raw(",");
+            }
+
+            raw("{\"ID\":").number(neuron.id)
+                .raw(",\"Type\":\"").raw(type_name(neuron.type))
+                .raw("\",\"ActivationResponse\":").number(neuron.activation_response)
+                .raw(",\"InLinks\":[");
+            for(std::size_t l = 0; l < neuron.in_links.size(); ++l)
+            {
+                if(l > 0)
+                {
+                    raw(",");
+                }
+                link(neuron.in_links[l].input_id, neuron.in_links[l].output_id, neuron.in_links[l].weight);
+            }
+
+            raw("],\"OutLinks\":[");
+            auto out_links = m_out_links.find(neuron.id);
+            if(out_links != m_out_links.end())
+            {
+                for(std::size_t l = 0; l < out_links->second.size(); ++l)
+                {
+                    if(l > 0)
+                    {
+                        raw(",");
+                    }
+                    auto out_link = out_links->second[l];
+                    link(out_link->input_id, out_link->output_id, out_link->weight);
+                }
+            }
+            raw("]}");
+        }
+        raw("]");
+    }
+
+private:
+    std::string& m_out;
+    std::unordered_map<int, std::vector<const LinkDescription*>> m_out_links;
+};
+
+}
+
+
+void write_network_json(const NetworkDescription& network, std::string& out)
+{
+    JsonWriter writer(out);
+    writer.network(network);
+}
+
+
+void write_population_json(const CachedNetworks& networks, std::string& out)
+{
+    JsonWriter writer(out);
+    writer.networks(networks);
+}
+
+
+void write_generation_json(const GenerationSummary& summary, const CachedNetworks& networks, std::string& out)
+{
+    JsonWriter writer(out);
+    writer.raw("{\"type\":\"generation\",\"generation\":").number(summary.generation)
+          .raw(",\"best_specie_id\":").number(summary.best_species_id)
+          .raw(",\"best_so_far\":").number(summary.best_so_far)
+          .raw(",\"species_stats\":{\"mean\":").number(summary.stats_mean)
+          .raw(",\"std\":").number(summary.stats_std)
+          .raw(",\"min\":").number(summary.stats_min)
+          .raw(",\"max\":").number(summary.stats_max)
+          .raw(",\"current\":").number(summary.stats_current)
+          .raw("},\"species\":{");
+    for(std::size_t s = 0; s < summary.species.size(); ++s)
+    {
+        if(s > 0)
+        {
+            writer.raw(",");
+        }
+        writer.raw("\"").number(summary.species[s].first).raw("\":").number(summary.species[s].second);
+    }
+    writer.raw("},\"brains\":");
+    writer.networks(networks);
+    writer.raw("}");
+}
+
+}
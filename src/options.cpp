@@ -0,0 +1,187 @@
+#include <sstream>
+#include <stdexcept>
+
+#include "options.h"
+
+
+namespace tank
+{
+
+namespace
+{
+
+/**
+ * Returns the value following the option at index i, advancing i past it.
+ */
+std::string next_value(int argc, const char* argv[], int& i)
+{
+    if(i + 1 >= argc)
+    {
+        throw std::invalid_argument(std::string("Missing value for ") + argv[i]);
+    }
+    return argv[++i];
+}
+
+
+int parse_int(const std::string& option, const std::string& value, int min_value)
+{
+    std::size_t parsed = 0;
+    int result = 0;
+    try
+    {
+        result = std::stoi(value, &parsed);
+    }
+    catch(const std::exception&)
+    {
+        parsed = 0;
+    }
+
+    if(parsed != value.size() || result < min_value)
+    {
+        throw std::invalid_argument("Invalid value for " + option + ": " + value);
+    }
+    return result;
+}
+
+
+int parse_port(const std::string& option, const std::string& value, int min_value)
+{
+    int port = parse_int(option, value, min_value);
+    if(port > 65535)
+    {
+        throw std::invalid_argument("Invalid value for " + option + ": " + value);
+    }
+    return port;
+}
+
+}
+
+
+Options parse_options(int argc, const char* argv[])
+{
+    Options options;
+    for(int i = 1; i < argc; ++i)
+    {
+        std::string option = argv[i];
+        if(option == "--headless")
+        {
+            options.headless = true;
+        }
+        else if(option == "--generations")
+        {
+            options.generations = parse_int(option, next_value(argc, argv, i), 1);
+        }
+        else if(option == "--frames")
+        {
+            options.frames = parse_int(option, next_value(argc, argv, i), 1);
+        }
+        else if(option == "--sim-threads")
+        {
+            options.sim_threads = parse_int(option, next_value(argc, argv, i), 0);
+        }
+        else if(option == "--workers-port")
+        {
+            options.workers_port = parse_port(option, next_value(argc, argv, i), 1);
+        }
+        else if(option == "--worker-batch")
+        {
+            options.worker_batch = parse_int(option, next_value(argc, argv, i), 1);
+        }
+        else if(option == "--worker-timeout")
+        {
+            options.worker_timeout = parse_int(option, next_value(argc, argv, i), 1);
+        }
+        else if(option == "--worker-resend")
+        {
+            std::string value = next_value(argc, argv, i);
+            options.worker_resend = parse_int(option, value, 1);
+            if(options.worker_resend > 100)
+            {
+                throw std::invalid_argument("Invalid value for " + option + ": " + value);
+            }
+        }
+        else if(option == "--worker")
+        {
+            std::string address = next_value(argc, argv, i);
+            auto colon = address.rfind(':');
+            if(colon == std::string::npos || colon == 0)
+            {
+                throw std::invalid_argument("Invalid value for " + option + ", expected HOST:PORT: " + address);
+            }
+            options.worker_host = address.substr(0, colon);
+            options.worker_port = parse_port(option, address.substr(colon + 1), 1);
+        }
+        else if(option == "--precompress")
+        {
+            options.precompress = true;
+        }
+        else if(option == "--port")
+        {
+            options.port = parse_port(option, next_value(argc, argv, i), 1);
+        }
+        else if(option == "--push-port")
+        {
+            options.push_port = parse_port(option, next_value(argc, argv, i), 0);
+        }
+        else if(option == "--no-push")
+        {
+            options.no_push = true;
+        }
+        else if(option == "--http-threads")
+        {
+            options.http_threads = parse_int(option, next_value(argc, argv, i), 0);
+        }
+        else if(option == "--keepalive-timeout")
+        {
+            options.keepalive_timeout = parse_int(option, next_value(argc, argv, i), 1);
+        }
+        else if(option == "--max-connections")
+        {
+            options.max_connections = parse_int(option, next_value(argc, argv, i), 0);
+        }
+        else if(option == "--max-sessions")
+        {
+            options.max_sessions = parse_int(option, next_value(argc, argv, i), 0);
+        }
+        else if(option == "--session-memory")
+        {
+            options.session_memory = parse_int(option, next_value(argc, argv, i), 0);
+        }
+        else
+        {
+            throw std::invalid_argument("Unknown option: " + option);
+        }
+    }
+    return options;
+}
+
+
+std::string usage(const std::string& program)
+{
+    std::stringstream ss;
+    ss << "Usage: " << program << " [options]\n"
+       << "  --headless          evolve using the native simulation instead of the browser\n"
+       << "  --generations N     number of generations to run in headless mode\n"
+       << "  --frames N          frames each bot is simulated for per generation\n"
+       << "  --sim-threads N     threads evaluating the population, 0 uses every core\n"
+       << "  --workers-port N    in headless mode, hand evaluation to workers connecting on this port\n"
+       << "  --worker-batch N    networks a worker evaluates at a time\n"
+       << "  --worker-timeout S  seconds before a batch not back goes to another worker\n"
+       << "  --worker-resend PCT percentage of networks back from the workers before the batches still out are\n"
+       << "                      sent to free workers as well, the first answer counts; 100 waits for the timeout\n"
+       << "  --worker HOST:PORT  evaluate batches for the coordinator at HOST:PORT\n"
+       << "  --precompress       serve static files compressed and revalidated by ETag\n"
+       << "  --port N            port the HTTP server listens on\n"
+       << "  --push-port N       port observers connect to over WebSocket, 0 uses the HTTP port + 1\n"
+       << "  --no-push           do not serve observers over WebSocket\n"
+       << "  --http-threads N    threads running the HTTP server, 0 uses every core\n"
+       << "  --keepalive-timeout S\n"
+       << "                      seconds an idle keep-alive connection is kept open\n"
+       << "  --max-connections N requests in flight, queued epochs included, before answering 503, 0 for no limit\n"
+       << "  --max-sessions N    populations evolving at once, the default one included, 0 for no limit\n"
+       << "  --session-memory MB memory a session started over /sessions may hold, its population included, before\n"
+       << "                      it is ended, 0 for no limit\n";
+    return ss.str();
+}
+
+}
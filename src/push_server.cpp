@@ -0,0 +1,286 @@
+#include <atomic>
+#include <deque>
+#include <iostream>
+#include <map>
+#include <set>
+#include <thread>
+
+#include <boost/asio.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/websocket.hpp>
+
+#include "push_server.h"
+
+
+namespace tank
+{
+
+namespace asio = boost::asio;
+namespace websocket = boost::beast::websocket;
+using tcp = asio::ip::tcp;
+
+struct Frame
+{
+    PushServer::Payload payload;
+    bool binary;
+};
+
+using Message = std::shared_ptr<const Frame>;
+
+
+/**
+ * Everything below runs on the single io thread, so sessions and retained messages need no locking.
+ */
+class PushServer::Impl
+{
+public:
+    class Session;
+
+    Impl(unsigned short port, std::size_t max_queued_messages);
+    ~Impl();
+
+    void publish(const std::string& topic, Message message, Message snapshot);
+
+    void add(const std::shared_ptr<Session>& session);
+    void remove(const std::shared_ptr<Session>& session);
+
+    const std::map<std::string, Message>& retained() const { return m_retained; }
+
+    std::size_t max_queued_messages() const { return m_max_queued_messages; }
+
+    std::size_t num_observers() const { return m_num_observers; }
+
+    unsigned short port() const { return m_port; }
+
+private:
+    void accept();
+
+    asio::io_context m_io;
+    tcp::acceptor m_acceptor;
+    unsigned short m_port;
+    std::size_t m_max_queued_messages;
+    std::atomic<std::size_t> m_num_observers;
+
+    std::set<std::shared_ptr<Session>> m_sessions;
+    std::map<std::string, Message> m_retained;
+    std::thread m_thread;
+};
+
+
+class PushServer::Impl::Session : public std::enable_shared_from_this<Session>
+{
+public:
+    Session(tcp::socket socket, Impl& server)
+        : m_ws(std::move(socket)),
+          m_server(server)
+    {
+    }
+
+    void start()
+    {
+        auto self = shared_from_this();
+        m_ws.async_accept([self](boost::system::error_code ec)
+        {
+            if(ec)
+            {
+                return;
+            }
+            self->m_server.add(self);
+            self->read();
+        });
+    }
+
+    void send(const Message& message)
+    {
+        if(m_queue.size() > m_server.max_queued_messages())
+        {
+            // the message at the front may be in the middle of being written, everything behind it gives way to
+            // the retained snapshots, which already hold the message being sent
+            m_queue.erase(m_queue.begin() + 1, m_queue.end());
+            for(auto& retained : m_server.retained())
+            {
+                m_queue.push_back(retained.second);
+            }
+            return;
+        }
+
+        m_queue.push_back(message);
+        if(m_queue.size() == 1)
+        {
+            write();
+        }
+    }
+
+    void close()
+    {
+        boost::system::error_code ec;
+        m_ws.next_layer().close(ec);
+    }
+
+private:
+    void read()
+    {
+        auto self = shared_from_this();
+        m_ws.async_read(m_buffer, [self](boost::system::error_code ec, std::size_t)
+        {
+            if(ec)
+            {
+                self->m_server.remove(self);
+                return;
+            }
+            self->m_buffer.consume(self->m_buffer.size());
+            self->read();
+        });
+    }
+
+    void write()
+    {
+        auto self = shared_from_this();
+        m_ws.binary(m_queue.front()->binary);
+        m_ws.async_write(asio::buffer(*m_queue.front()->payload), [self](boost::system::error_code ec, std::size_t)
+        {
+            if(ec)
+            {
+                self->m_server.remove(self);
+                return;
+            }
+
+            self->m_queue.pop_front();
+            if(!self->m_queue.empty())
+            {
+                self->write();
+            }
+        });
+    }
+
+    websocket::stream<tcp::socket> m_ws;
+    boost::beast::flat_buffer m_buffer;
+    std::deque<Message> m_queue;
+    Impl& m_server;
+};
+
+
+PushServer::Impl::Impl(unsigned short port, std::size_t max_queued_messages)
+    : m_acceptor(m_io, tcp::endpoint(tcp::v4(), port)),
+      m_port(m_acceptor.local_endpoint().port()),
+      m_max_queued_messages(max_queued_messages),
+      m_num_observers(0)
+{
+    accept();
+    m_thread = std::thread([this]() { m_io.run(); });
+}
+
+
+PushServer::Impl::~Impl()
+{
+    m_io.stop();
+    m_thread.join();
+
+    for(auto& session : m_sessions)
+    {
+        session->close();
+    }
+    m_sessions.clear();
+}
+
+
+void PushServer::Impl::publish(const std::string& topic, Message message, Message snapshot)
+{
+    asio::post(m_io, [this, topic, message, snapshot]()
+    {
+        m_retained[topic] = snapshot;
+        for(auto& session : m_sessions)
+        {
+            session->send(message);
+        }
+    });
+}
+
+
+void PushServer::Impl::add(const std::shared_ptr<Session>& session)
+{
+    m_sessions.insert(session);
+    m_num_observers = m_sessions.size();
+
+    for(auto& retained : m_retained)
+    {
+        session->send(retained.second);
+    }
+}
+
+
+void PushServer::Impl::remove(const std::shared_ptr<Session>& session)
+{
+    m_sessions.erase(session);
+    m_num_observers = m_sessions.size();
+}
+
+
+void PushServer::Impl::accept()
+{
+    m_acceptor.async_accept([this](boost::system::error_code ec, tcp::socket socket)
+    {
+        if(!ec)
+        {
+            std::make_shared<Session>(std::move(socket), *this)->start();
+        }
+        else
+        {
+            std::cerr << "Push server could not accept a connection: " << ec.message() << std::endl;
+        }
+        accept();
+    });
+}
+
+
+PushServer::PushServer(unsigned short port, std::size_t max_queued_messages)
+    : m_impl(new Impl(port, max_queued_messages))
+{
+}
+
+
+PushServer::~PushServer() = default;
+
+
+void PushServer::publish(const std::string& topic, std::string message, bool binary)
+{
+    publish(topic, std::make_shared<const std::string>(std::move(message)), binary);
+}
+
+
+void PushServer::publish(const std::string& topic, std::string message, std::string snapshot, bool binary)
+{
+    publish(topic,
+            std::make_shared<const std::string>(std::move(message)),
+            std::make_shared<const std::string>(std::move(snapshot)),
+            binary);
+}
+
+
+void PushServer::publish(const std::string& topic, Payload message, bool binary)
+{
+    auto frame = std::make_shared<const Frame>(Frame{std::move(message), binary});
+    m_impl->publish(topic, frame, frame);
+}
+
+
+void PushServer::publish(const std::string& topic, Payload message, Payload snapshot, bool binary)
+{
+    m_impl->publish(topic,
+                    std::make_shared<const Frame>(Frame{std::move(message), binary}),
+                    std::make_shared<const Frame>(Frame{std::move(snapshot), binary}));
+}
+
+
+std::size_t PushServer::num_observers() const
+{
+    return m_impl->num_observers();
+}
+
+
+unsigned short PushServer::port() const
+{
+    return m_impl->port();
+}
+
+}
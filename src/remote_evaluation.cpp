@@ -0,0 +1,598 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <numeric>
+#include <random>
+#include <set>
+#include <thread>
+
+#include <boost/asio.hpp>
+
+#include "remote_evaluation.h"
+#include "simulation.h"
+#include "wire_format.h"
+
+
+namespace tank
+{
+
+namespace asio = boost::asio;
+using tcp = asio::ip::tcp;
+
+namespace
+{
+
+// a message bigger than this is taken for garbage rather than allocated
+const std::uint32_t MAX_MESSAGE_SIZE = 64 * 1024 * 1024;
+
+
+/**
+ * Prepends the size of a message, how messages travel between coordinator and workers.
+ */
+std::shared_ptr<const std::string> frame_message(const std::string& message)
+{
+    auto size = static_cast<std::uint32_t>(message.size());
+    auto framed = std::make_shared<std::string>();
+    framed->reserve(message.size() + 4);
+    for(int i = 0; i < 4; ++i)
+    {
+        framed->push_back(static_cast<char>(size >> (8 * i)));
+    }
+    framed->append(message);
+    return framed;
+}
+
+
+std::uint32_t read_frame_size(const char* bytes)
+{
+    std::uint32_t size = 0;
+    for(int i = 0; i < 4; ++i)
+    {
+        size |= static_cast<std::uint32_t>(static_cast<std::uint8_t>(bytes[i])) << (8 * i);
+    }
+    return size;
+}
+
+}
+
+
+/**
+ * Everything below runs on the single io thread, only the results of a job are shared with the thread waiting for
+ * them.
+ */
+class EvaluationCoordinator::Impl
+{
+public:
+    class Worker;
+
+    /**
+     * The fitnesses of one evaluate call, filled in batch by batch.
+     */
+    struct Job
+    {
+        std::mutex mutex;
+        std::condition_variable done;
+        std::vector<double> fitnesses;
+        std::size_t num_evaluated = 0;
+        std::size_t resend_after = 0;
+        std::size_t remaining_batches = 0;
+        bool complete = false;
+    };
+
+    struct Batch
+    {
+        std::shared_ptr<Job> job;
+
+        // where the fitnesses of the batch go in those of the job
+        std::vector<std::size_t> indices;
+        std::shared_ptr<const std::string> message;
+
+        // the worker simulating the batch and when it has to be back, nullptr while the batch waits
+        Worker* worker = nullptr;
+        std::chrono::steady_clock::time_point deadline;
+
+        // sent again to a free worker once enough of the job was back
+        bool resent = false;
+    };
+
+    Impl(unsigned short port, std::size_t batch_size, std::chrono::milliseconds batch_timeout, double resend_share);
+    ~Impl();
+
+    std::vector<double> evaluate(const std::vector<NetworkDescription>& networks, int frames);
+
+    std::size_t num_workers() const { return m_num_workers; }
+
+    void add(const std::shared_ptr<Worker>& worker);
+    void remove(const std::shared_ptr<Worker>& worker);
+    void answered(const std::shared_ptr<Worker>& worker, const std::string& message);
+
+private:
+    void accept();
+    void dispatch();
+    void check_deadlines();
+
+    /**
+     * Queues the batches of a job with its resend share back again, the ones out on a worker included. The slow
+     * workers stay busy with them, whoever answers first wins.
+     */
+    void resend(const std::shared_ptr<Job>& job);
+
+    asio::io_context m_io;
+    tcp::acceptor m_acceptor;
+    asio::steady_timer m_timer;
+    std::size_t m_batch_size;
+    std::chrono::milliseconds m_batch_timeout;
+    double m_resend_share;
+    std::atomic<std::size_t> m_num_workers;
+
+    std::set<std::shared_ptr<Worker>> m_workers;
+    std::map<std::uint64_t, Batch> m_outstanding;
+    std::deque<std::uint64_t> m_waiting;
+    std::atomic<std::uint64_t> m_next_batch_id;
+
+    std::mutex m_random_mutex;
+    std::mt19937 m_random;
+
+    std::thread m_thread;
+};
+
+
+class EvaluationCoordinator::Impl::Worker : public std::enable_shared_from_this<Worker>
+{
+public:
+    Worker(tcp::socket socket, Impl& coordinator)
+        : m_socket(std::move(socket)),
+          m_coordinator(coordinator),
+          m_batch(0)
+    {
+    }
+
+    void start()
+    {
+        m_coordinator.add(shared_from_this());
+        read_size();
+    }
+
+    /**
+     * Batch the worker is simulating, 0 if it is free.
+     */
+    std::uint64_t batch() const { return m_batch; }
+
+    void send(std::uint64_t batch, const std::shared_ptr<const std::string>& message)
+    {
+        m_batch = batch;
+        auto self = shared_from_this();
+        asio::async_write(m_socket, asio::buffer(*message), [self, message](boost::system::error_code ec, std::size_t)
+        {
+            if(ec)
+            {
+                self->fail();
+            }
+        });
+    }
+
+    void finished() { m_batch = 0; }
+
+    void close()
+    {
+        boost::system::error_code ec;
+        m_socket.close(ec);
+    }
+
+    /**
+     * Drops the worker, its batch goes to another one.
+     */
+    void fail()
+    {
+        close();
+        m_coordinator.remove(shared_from_this());
+    }
+
+private:
+    void read_size()
+    {
+        auto self = shared_from_this();
+        asio::async_read(m_socket, asio::buffer(m_size, sizeof(m_size)),
+                         [self](boost::system::error_code ec, std::size_t)
+        {
+            if(ec)
+            {
+                self->fail();
+                return;
+            }
+
+            std::uint32_t size = read_frame_size(self->m_size);
+            if(size > MAX_MESSAGE_SIZE)
+            {
+                std::cerr << "Evaluation worker sent a message of " << size << " bytes, dropping it" << std::endl;
+                self->fail();
+                return;
+            }
+            self->m_message.resize(size);
+            self->read_message();
+        });
+    }
+
+    void read_message()
+    {
+        auto self = shared_from_this();
+        asio::async_read(m_socket, asio::buffer(&m_message[0], m_message.size()),
+                         [self](boost::system::error_code ec, std::size_t)
+        {
+            if(ec)
+            {
+                self->fail();
+                return;
+            }
+            self->m_coordinator.answered(self, self->m_message);
+            if(self->m_socket.is_open())
+            {
+                self->read_size();
+            }
+        });
+    }
+
+    tcp::socket m_socket;
+    Impl& m_coordinator;
+    std::uint64_t m_batch;
+    char m_size[4];
+    std::string m_message;
+};
+
+
+EvaluationCoordinator::Impl::Impl(unsigned short port, std::size_t batch_size, std::chrono::milliseconds batch_timeout,
+                                  double resend_share)
+    : m_acceptor(m_io, tcp::endpoint(tcp::v4(), port)),
+      m_timer(m_io),
+      m_batch_size(std::max<std::size_t>(batch_size, 1)),
+      m_batch_timeout(batch_timeout),
+      m_resend_share(std::min(std::max(resend_share, 0.0), 1.0)),
+      m_num_workers(0),
+      m_next_batch_id(1),
+      m_random(std::random_device()())
+{
+    accept();
+    check_deadlines();
+    m_thread = std::thread([this]() { m_io.run(); });
+}
+
+
+EvaluationCoordinator::Impl::~Impl()
+{
+    m_io.stop();
+    m_thread.join();
+
+    for(auto& worker : m_workers)
+    {
+        worker->close();
+    }
+    m_workers.clear();
+}
+
+
+std::vector<double> EvaluationCoordinator::Impl::evaluate(const std::vector<NetworkDescription>& networks, int frames)
+{
+    auto job = std::make_shared<Job>();
+    job->fitnesses.resize(networks.size(), 0.0);
+    if(networks.empty())
+    {
+        return job->fitnesses;
+    }
+    auto resend_after = static_cast<std::size_t>(std::ceil(m_resend_share * networks.size()));
+    job->resend_after = std::max<std::size_t>(resend_after, 1);
+
+    std::vector<std::size_t> order(networks.size());
+    std::iota(order.begin(), order.end(), 0);
+    {
+        std::lock_guard<std::mutex> lock(m_random_mutex);
+        std::shuffle(order.begin(), order.end(), m_random);
+    }
+
+    // batches are encoded here, the io thread only moves bytes
+    std::vector<std::pair<std::uint64_t, Batch>> batches;
+    std::vector<NetworkDescription> batch_networks;
+    std::string message;
+    for(std::size_t begin = 0; begin < networks.size(); begin += m_batch_size)
+    {
+        Batch batch;
+        batch.job = job;
+        batch.indices.assign(order.begin() + begin, order.begin() + std::min(begin + m_batch_size, networks.size()));
+
+        batch_networks.clear();
+        for(auto index : batch.indices)
+        {
+            batch_networks.push_back(networks[index]);
+        }
+
+        std::uint64_t id = m_next_batch_id++;
+        encode_evaluation_request(id, frames, batch_networks, message);
+        batch.message = frame_message(message);
+        batches.emplace_back(id, std::move(batch));
+    }
+    job->remaining_batches = batches.size();
+
+    asio::post(m_io, [this, batches]()
+    {
+        for(auto& batch : batches)
+        {
+            m_outstanding.emplace(batch.first, batch.second);
+            m_waiting.push_back(batch.first);
+        }
+
+        if(m_workers.empty())
+        {
+            std::cout << "Waiting for evaluation workers to connect" << std::endl;
+        }
+        dispatch();
+    });
+
+    std::unique_lock<std::mutex> lock(job->mutex);
+    job->done.wait(lock, [&job]() { return job->complete; });
+    return job->fitnesses;
+}
+
+
+void EvaluationCoordinator::Impl::add(const std::shared_ptr<Worker>& worker)
+{
+    m_workers.insert(worker);
+    m_num_workers = m_workers.size();
+    dispatch();
+}
+
+
+void EvaluationCoordinator::Impl::remove(const std::shared_ptr<Worker>& worker)
+{
+    if(m_workers.erase(worker) == 0)
+    {
+        return;
+    }
+    m_num_workers = m_workers.size();
+
+    auto it = m_outstanding.find(worker->batch());
+    if(it != m_outstanding.end() && it->second.worker == worker.get())
+    {
+        it->second.worker = nullptr;
+        m_waiting.push_front(it->first);
+    }
+    dispatch();
+}
+
+
+void EvaluationCoordinator::Impl::answered(const std::shared_ptr<Worker>& worker, const std::string& message)
+{
+    std::uint64_t batch_id = 0;
+    std::vector<double> fitnesses;
+    try
+    {
+        fitnesses = decode_fitnesses(message.data(), message.size(), batch_id);
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << "Dropping evaluation worker: " << e.what() << std::endl;
+        worker->fail();
+        return;
+    }
+
+    // a batch handed to another worker after a timeout may come back twice, the first answer counts
+    auto it = m_outstanding.find(batch_id);
+    if(it != m_outstanding.end())
+    {
+        auto& batch = it->second;
+        if(fitnesses.size() != batch.indices.size())
+        {
+            std::cerr << "Dropping evaluation worker: got " << fitnesses.size() << " fitnesses for a batch of "
+                      << batch.indices.size() << std::endl;
+            worker->fail();
+            return;
+        }
+
+        auto job = batch.job;
+        m_waiting.erase(std::remove(m_waiting.begin(), m_waiting.end(), batch_id), m_waiting.end());
+        bool complete = false;
+        bool resend_due = false;
+        {
+            std::lock_guard<std::mutex> lock(job->mutex);
+            for(std::size_t i = 0; i < fitnesses.size(); ++i)
+            {
+                job->fitnesses[batch.indices[i]] = fitnesses[i];
+            }
+            job->num_evaluated += fitnesses.size();
+            --job->remaining_batches;
+
+            complete = job->remaining_batches == 0;
+            resend_due = job->num_evaluated >= job->resend_after;
+            job->complete = complete;
+        }
+        m_outstanding.erase(it);
+        if(complete)
+        {
+            job->done.notify_one();
+        }
+        else if(resend_due)
+        {
+            resend(job);
+        }
+    }
+
+    if(worker->batch() == batch_id)
+    {
+        worker->finished();
+    }
+    dispatch();
+}
+
+
+void EvaluationCoordinator::Impl::resend(const std::shared_ptr<Job>& job)
+{
+    for(auto& entry : m_outstanding)
+    {
+        auto& batch = entry.second;
+        if(batch.job == job && batch.worker && !batch.resent)
+        {
+            batch.worker = nullptr;
+            batch.resent = true;
+            m_waiting.push_back(entry.first);
+        }
+    }
+}
+
+
+void EvaluationCoordinator::Impl::accept()
+{
+    m_acceptor.async_accept([this](boost::system::error_code ec, tcp::socket socket)
+    {
+        if(!ec)
+        {
+            boost::system::error_code option_ec;
+            socket.set_option(tcp::no_delay(true), option_ec);
+            std::make_shared<Worker>(std::move(socket), *this)->start();
+        }
+        else
+        {
+            std::cerr << "Coordinator could not accept a worker: " << ec.message() << std::endl;
+        }
+        accept();
+    });
+}
+
+
+void EvaluationCoordinator::Impl::dispatch()
+{
+    for(auto& worker : m_workers)
+    {
+        if(m_waiting.empty())
+        {
+            return;
+        }
+        if(worker->batch() != 0)
+        {
+            continue;
+        }
+
+        std::uint64_t id = m_waiting.front();
+        m_waiting.pop_front();
+
+        auto& batch = m_outstanding.at(id);
+        batch.worker = worker.get();
+        batch.deadline = std::chrono::steady_clock::now() + m_batch_timeout;
+        worker->send(id, batch.message);
+    }
+}
+
+
+void EvaluationCoordinator::Impl::check_deadlines()
+{
+    auto now = std::chrono::steady_clock::now();
+    for(auto& entry : m_outstanding)
+    {
+        auto& batch = entry.second;
+        if(batch.worker && batch.deadline < now)
+        {
+            // the slow worker stays busy with it, whoever answers first wins
+            batch.worker = nullptr;
+            m_waiting.push_back(entry.first);
+        }
+    }
+    dispatch();
+
+    m_timer.expires_after(std::chrono::seconds(1));
+    m_timer.async_wait([this](boost::system::error_code ec)
+    {
+        if(!ec)
+        {
+            check_deadlines();
+        }
+    });
+}
+
+
+EvaluationCoordinator::EvaluationCoordinator(unsigned short port, std::size_t batch_size,
+                                             std::chrono::milliseconds batch_timeout, double resend_share)
+    : m_impl(new Impl(port, batch_size, batch_timeout, resend_share))
+{
+}
+
+
+EvaluationCoordinator::~EvaluationCoordinator() = default;
+
+
+std::vector<double> EvaluationCoordinator::evaluate(const std::vector<NetworkDescription>& networks, int frames)
+{
+    return m_impl->evaluate(networks, frames);
+}
+
+
+std::size_t EvaluationCoordinator::num_workers() const
+{
+    return m_impl->num_workers();
+}
+
+
+EvaluationWorker::EvaluationWorker(World world, TaskPool& pool)
+    : m_world(std::move(world)),
+      m_pool(pool)
+{
+}
+
+
+void EvaluationWorker::run(const std::string& host, unsigned short port)
+{
+    asio::io_context io;
+    std::unique_ptr<Simulation> simulation;
+    std::string message;
+    std::string answer;
+
+    while(true)
+    {
+        tcp::socket socket(io);
+        try
+        {
+            tcp::resolver resolver(io);
+            asio::connect(socket, resolver.resolve(host, std::to_string(port)));
+            socket.set_option(tcp::no_delay(true));
+            std::cout << "Connected to coordinator at " << host << ":" << port << std::endl;
+
+            while(true)
+            {
+                char size_bytes[4];
+                asio::read(socket, asio::buffer(size_bytes, sizeof(size_bytes)));
+                std::uint32_t size = read_frame_size(size_bytes);
+                if(size > MAX_MESSAGE_SIZE)
+                {
+                    throw std::invalid_argument("Coordinator sent a message of " + std::to_string(size) + " bytes");
+                }
+
+                message.resize(size);
+                asio::read(socket, asio::buffer(&message[0], message.size()));
+                auto request = decode_evaluation_request(message.data(), message.size());
+
+                if(!simulation || simulation->frames() != request.frames)
+                {
+                    simulation.reset(new Simulation(m_world, m_pool, request.frames));
+                }
+
+                encode_fitnesses(request.batch_id, simulation->evaluate(request.networks), answer);
+                asio::write(socket, asio::buffer(*frame_message(answer)));
+            }
+        }
+        catch(const boost::system::system_error& e)
+        {
+            std::cerr << "Lost coordinator at " << host << ":" << port << ": " << e.what() << std::endl;
+        }
+        catch(const std::invalid_argument& e)
+        {
+            std::cerr << "Coordinator sent a malformed message: " << e.what() << std::endl;
+            return;
+        }
+
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+    }
+}
+
+}
@@ -0,0 +1,30 @@
+#include "request_limiter.h"
+
+
+namespace tank
+{
+
+RequestLimiter::RequestLimiter(unsigned max_requests)
+    : m_max_requests(max_requests),
+      m_in_flight(0)
+{
+}
+
+
+RequestLimiter::Ticket RequestLimiter::try_acquire()
+{
+    unsigned in_flight = m_in_flight.fetch_add(1) + 1;
+    if(m_max_requests > 0 && in_flight > m_max_requests)
+    {
+        --m_in_flight;
+        return nullptr;
+    }
+
+    // the ticket owns no object, its deleter only gives the slot back
+    return Ticket(static_cast<void*>(this), [](void* limiter)
+    {
+        --static_cast<RequestLimiter*>(limiter)->m_in_flight;
+    });
+}
+
+}
@@ -0,0 +1,115 @@
+#include <algorithm>
+#include <cmath>
+
+#include "segment_grid.h"
+
+
+namespace tank
+{
+
+namespace
+{
+
+/**
+ * Liang-Barsky test of segment CD against the box [min_x, max_x] x [min_y, max_y].
+ */
+bool segment_touches_box(Vec2 c, Vec2 d, float min_x, float min_y, float max_x, float max_y)
+{
+    float t0 = 0.0f;
+    float t1 = 1.0f;
+    float dx = d.x - c.x;
+    float dy = d.y - c.y;
+
+    float p[4] = {-dx, dx, -dy, dy};
+    float q[4] = {c.x - min_x, max_x - c.x, c.y - min_y, max_y - c.y};
+    for(int i = 0; i < 4; ++i)
+    {
+        if(p[i] == 0.0f)
+        {
+            if(q[i] < 0.0f)
+            {
+                return false;
+            }
+            continue;
+        }
+
+        float t = q[i] / p[i];
+        if(p[i] < 0.0f)
+        {
+            t0 = std::max(t0, t);
+        }
+        else
+        {
+            t1 = std::min(t1, t);
+        }
+
+        if(t0 > t1)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+}
+
+
+SegmentGrid::SegmentGrid(const std::vector<Polygon>& polygons, float width, float height, float cell_size,
+                         float reach)
+    : m_cell_size(cell_size),
+      m_num_cells_x(static_cast<int>(std::floor(width / cell_size)) + 1),
+      m_num_cells_y(static_cast<int>(std::floor(height / cell_size)) + 1),
+      m_cells(m_num_cells_x * m_num_cells_y)
+{
+    // sensor end points are rotated in single precision, leave a little slack around the nominal range
+    float margin = reach + 1.0f;
+
+    for(auto& polygon : polygons)
+    {
+        for(std::size_t i = 0; i + 1 < polygon.size(); ++i)
+        {
+            Vec2 c = polygon[i];
+            Vec2 d = polygon[i + 1];
+
+            // only cells whose inflated box overlaps the segment's bounding box can be touched
+            int first_x = std::max(0, static_cast<int>(std::floor((std::min(c.x, d.x) - margin) / cell_size)));
+            int last_x = std::min(m_num_cells_x - 1,
+                                  static_cast<int>(std::floor((std::max(c.x, d.x) + margin) / cell_size)));
+            int first_y = std::max(0, static_cast<int>(std::floor((std::min(c.y, d.y) - margin) / cell_size)));
+            int last_y = std::min(m_num_cells_y - 1,
+                                  static_cast<int>(std::floor((std::max(c.y, d.y) + margin) / cell_size)));
+
+            for(int x = first_x; x <= last_x; ++x)
+            {
+                for(int y = first_y; y <= last_y; ++y)
+                {
+                    if(segment_touches_box(c, d,
+                                           x * cell_size - margin, y * cell_size - margin,
+                                           (x + 1) * cell_size + margin, (y + 1) * cell_size + margin))
+                    {
+                        m_cells[x * m_num_cells_y + y].add(c, d);
+                    }
+                }
+            }
+        }
+    }
+}
+
+
+const SegmentSet* SegmentGrid::query(Vec2 origin) const
+{
+    if(!(origin.x >= 0 && origin.y >= 0))
+    {
+        return nullptr;
+    }
+
+    int cellx = static_cast<int>(origin.x / m_cell_size);
+    int celly = static_cast<int>(origin.y / m_cell_size);
+    if(cellx >= m_num_cells_x || celly >= m_num_cells_y)
+    {
+        return nullptr;
+    }
+    return &m_cells[cellx * m_num_cells_y + celly];
+}
+
+}
@@ -0,0 +1,223 @@
+#include <algorithm>
+#include <limits>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "segment_set.h"
+
+
+namespace tank
+{
+
+namespace
+{
+
+const float INF = std::numeric_limits<float>::infinity();
+
+
+#if defined(__AVX2__)
+
+struct Lanes
+{
+    static const int WIDTH = 8;
+    using V = __m256;
+
+    static V load(const float* p) { return _mm256_loadu_ps(p); }
+    static void store(float* p, V a) { _mm256_storeu_ps(p, a); }
+    static V set1(float a) { return _mm256_set1_ps(a); }
+    static V add(V a, V b) { return _mm256_add_ps(a, b); }
+    static V sub(V a, V b) { return _mm256_sub_ps(a, b); }
+    static V mul(V a, V b) { return _mm256_mul_ps(a, b); }
+    static V div(V a, V b) { return _mm256_div_ps(a, b); }
+    static V min(V a, V b) { return _mm256_min_ps(a, b); }
+    static V gt(V a, V b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+    static V le(V a, V b) { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+    static V both(V a, V b) { return _mm256_and_ps(a, b); }
+    static bool any(V mask) { return _mm256_movemask_ps(mask) != 0; }
+    static V select(V mask, V a, V b) { return _mm256_blendv_ps(b, a, mask); }
+};
+
+#elif defined(__SSE2__)
+
+struct Lanes
+{
+    static const int WIDTH = 4;
+    using V = __m128;
+
+    static V load(const float* p) { return _mm_loadu_ps(p); }
+    static void store(float* p, V a) { _mm_storeu_ps(p, a); }
+    static V set1(float a) { return _mm_set1_ps(a); }
+    static V add(V a, V b) { return _mm_add_ps(a, b); }
+    static V sub(V a, V b) { return _mm_sub_ps(a, b); }
+    static V mul(V a, V b) { return _mm_mul_ps(a, b); }
+    static V div(V a, V b) { return _mm_div_ps(a, b); }
+    static V min(V a, V b) { return _mm_min_ps(a, b); }
+    static V gt(V a, V b) { return _mm_cmpgt_ps(a, b); }
+    static V le(V a, V b) { return _mm_cmple_ps(a, b); }
+    static V both(V a, V b) { return _mm_and_ps(a, b); }
+    static bool any(V mask) { return _mm_movemask_ps(mask) != 0; }
+    static V select(V mask, V a, V b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+};
+
+#else
+
+struct Lanes
+{
+    static const int WIDTH = 1;
+    using V = float;
+
+    static V load(const float* p) { return *p; }
+    static void store(float* p, V a) { *p = a; }
+    static V set1(float a) { return a; }
+    static V add(V a, V b) { return a + b; }
+    static V sub(V a, V b) { return a - b; }
+    static V mul(V a, V b) { return a * b; }
+    static V div(V a, V b) { return a / b; }
+    static V min(V a, V b) { return std::min(a, b); }
+    static V gt(V a, V b) { return a > b ? 1.0f : 0.0f; }
+    static V le(V a, V b) { return a <= b ? 1.0f : 0.0f; }
+    static V both(V a, V b) { return a * b; }
+    static bool any(V mask) { return mask != 0.0f; }
+    static V select(V mask, V a, V b) { return mask != 0.0f ? a : b; }
+};
+
+#endif
+
+static_assert(SegmentSet::BLOCK % Lanes::WIDTH == 0, "Segment blocks must hold whole SIMD registers");
+
+}
+
+
+SegmentSet::SegmentSet(const std::vector<Polygon>& polygons)
+{
+    for(auto& polygon : polygons)
+    {
+        for(std::size_t i = 0; i + 1 < polygon.size(); ++i)
+        {
+            add(polygon[i], polygon[i + 1]);
+        }
+    }
+}
+
+
+void SegmentSet::add(Vec2 c, Vec2 d)
+{
+    // reuse the first padding slot, or grow by a block of padding
+    if(m_size == m_x.size())
+    {
+        std::size_t padded = m_x.size() + BLOCK;
+        m_x.resize(padded, 0.0f);
+        m_y.resize(padded, 0.0f);
+        m_dx.resize(padded, 0.0f);
+        m_dy.resize(padded, 0.0f);
+        m_min_x.resize(padded, INF);
+        m_max_x.resize(padded, -INF);
+        m_min_y.resize(padded, INF);
+        m_max_y.resize(padded, -INF);
+    }
+
+    m_x[m_size] = c.x;
+    m_y[m_size] = c.y;
+    m_dx[m_size] = d.x - c.x;
+    m_dy[m_size] = d.y - c.y;
+    m_min_x[m_size] = std::min(c.x, d.x);
+    m_max_x[m_size] = std::max(c.x, d.x);
+    m_min_y[m_size] = std::min(c.y, d.y);
+    m_max_y[m_size] = std::max(c.y, d.y);
+    ++m_size;
+}
+
+
+void SegmentSet::cast(Vec2 origin, const SensorArray& ends, SensorDepths& depths) const
+{
+    using V = Lanes::V;
+
+    // bounding box of every ray and of all of them together
+    float ray_min_x[NUM_SENSORS], ray_max_x[NUM_SENSORS], ray_min_y[NUM_SENSORS], ray_max_y[NUM_SENSORS];
+    float all_min_x = origin.x, all_max_x = origin.x, all_min_y = origin.y, all_max_y = origin.y;
+    for(int s = 0; s < NUM_SENSORS; ++s)
+    {
+        ray_min_x[s] = std::min(origin.x, ends[s].x);
+        ray_max_x[s] = std::max(origin.x, ends[s].x);
+        ray_min_y[s] = std::min(origin.y, ends[s].y);
+        ray_max_y[s] = std::max(origin.y, ends[s].y);
+        all_min_x = std::min(all_min_x, ray_min_x[s]);
+        all_max_x = std::max(all_max_x, ray_max_x[s]);
+        all_min_y = std::min(all_min_y, ray_min_y[s]);
+        all_max_y = std::max(all_max_y, ray_max_y[s]);
+    }
+
+    V best[NUM_SENSORS];
+    std::fill(best, best + NUM_SENSORS, Lanes::set1(INF));
+
+    V ax = Lanes::set1(origin.x);
+    V ay = Lanes::set1(origin.y);
+    for(std::size_t i = 0; i < m_x.size(); i += Lanes::WIDTH)
+    {
+        V min_x = Lanes::load(&m_min_x[i]);
+        V max_x = Lanes::load(&m_max_x[i]);
+        V min_y = Lanes::load(&m_min_y[i]);
+        V max_y = Lanes::load(&m_max_y[i]);
+
+        // reject the whole register if no ray can reach any of its segments
+        V near = Lanes::both(Lanes::both(Lanes::le(Lanes::set1(all_min_x), max_x),
+                                         Lanes::le(min_x, Lanes::set1(all_max_x))),
+                             Lanes::both(Lanes::le(Lanes::set1(all_min_y), max_y),
+                                         Lanes::le(min_y, Lanes::set1(all_max_y))));
+        if(!Lanes::any(near))
+        {
+            continue;
+        }
+
+        V dx = Lanes::load(&m_dx[i]);
+        V dy = Lanes::load(&m_dy[i]);
+        V acx = Lanes::sub(ax, Lanes::load(&m_x[i]));
+        V acy = Lanes::sub(ay, Lanes::load(&m_y[i]));
+        V r_top = Lanes::sub(Lanes::mul(acy, dx), Lanes::mul(acx, dy));
+
+        for(int s = 0; s < NUM_SENSORS; ++s)
+        {
+            V overlap = Lanes::both(Lanes::both(Lanes::le(Lanes::set1(ray_min_x[s]), max_x),
+                                                Lanes::le(min_x, Lanes::set1(ray_max_x[s]))),
+                                    Lanes::both(Lanes::le(Lanes::set1(ray_min_y[s]), max_y),
+                                                Lanes::le(min_y, Lanes::set1(ray_max_y[s]))));
+            if(!Lanes::any(overlap))
+            {
+                continue;
+            }
+
+            V bax = Lanes::set1(ends[s].x - origin.x);
+            V bay = Lanes::set1(ends[s].y - origin.y);
+            V r_bot = Lanes::sub(Lanes::mul(bax, dy), Lanes::mul(bay, dx));
+            V s_top = Lanes::sub(Lanes::mul(acy, bax), Lanes::mul(acx, bay));
+
+            V r_top_bot = Lanes::mul(r_top, r_bot);
+            V s_top_bot = Lanes::mul(s_top, r_bot);
+            V r_bot_sq = Lanes::mul(r_bot, r_bot);
+            V zero = Lanes::set1(0.0f);
+
+            V hit = Lanes::both(Lanes::both(Lanes::gt(r_top_bot, zero), Lanes::gt(r_bot_sq, r_top_bot)),
+                                Lanes::both(Lanes::gt(s_top_bot, zero), Lanes::gt(r_bot_sq, s_top_bot)));
+            hit = Lanes::both(hit, overlap);
+            if(Lanes::any(hit))
+            {
+                V depth = Lanes::div(r_top, r_bot);
+                best[s] = Lanes::min(best[s], Lanes::select(hit, depth, Lanes::set1(INF)));
+            }
+        }
+    }
+
+    for(int s = 0; s < NUM_SENSORS; ++s)
+    {
+        float lanes[Lanes::WIDTH];
+        Lanes::store(lanes, best[s]);
+        float nearest = *std::min_element(lanes, lanes + Lanes::WIDTH);
+        depths[s] = nearest == INF ? NO_COLLISION : nearest;
+    }
+}
+
+}
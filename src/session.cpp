@@ -0,0 +1,435 @@
+#include <atomic>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <stdexcept>
+
+#include <boost/filesystem.hpp>
+
+#include "consts.h"
+#include "session.h"
+
+
+namespace tank
+{
+
+namespace
+{
+
+/**
+ * Highest values of the integer parameters that size a population and the work of its epochs. Sessions are created
+ * by clients, a population of any size would let a single request take all of the server's memory.
+ */
+const std::map<std::string, long long> PARAMETER_CAPS = {
+    {"PopulationSize", 10000},
+    {"MaxPermittedNeurons", 1000},
+    {"NumBestGenomes", 100},
+    {"NumAddLinkAttempts", 100},
+    {"NumAddRecurLinkAttempts", 100},
+    {"NumFindOldLinkAttempts", 100}
+};
+
+
+/**
+ * Deletes a file when it goes out of scope.
+ */
+class TemporaryFile
+{
+public:
+    explicit TemporaryFile(boost::filesystem::path path)
+        : m_path(std::move(path))
+    {
+    }
+
+    ~TemporaryFile()
+    {
+        boost::system::error_code ec;
+        boost::filesystem::remove(m_path, ec);
+    }
+
+    TemporaryFile(const TemporaryFile&) = delete;
+    TemporaryFile& operator=(const TemporaryFile&) = delete;
+
+    const boost::filesystem::path& path() const { return m_path; }
+
+private:
+    boost::filesystem::path m_path;
+};
+
+
+/**
+ * What a parameter value is, in the words of the error refusing it. Integers and fractional numbers are told apart,
+ * since neat::Params reads some parameters as int.
+ */
+std::string kind_of(const nlohmann::json& value)
+{
+    if(value.is_number_integer())
+    {
+        return "an integer";
+    }
+    if(value.is_number())
+    {
+        return "a number";
+    }
+    if(value.is_boolean())
+    {
+        return "a boolean";
+    }
+    if(value.is_string())
+    {
+        return "a string";
+    }
+    if(value.is_array())
+    {
+        return "an array";
+    }
+    if(value.is_object())
+    {
+        return "an object";
+    }
+    return "null";
+}
+
+
+/**
+ * Whether a value can replace the default of a parameter. An integer may stand in for a fractional number, not the
+ * other way around.
+ */
+bool same_kind(const nlohmann::json& value, const nlohmann::json& default_value)
+{
+    if(default_value.is_number_float())
+    {
+        return value.is_number();
+    }
+    return kind_of(value) == kind_of(default_value);
+}
+
+
+/**
+ * Bytes of a network of the first generation: inputs, bias and outputs, every output linked from every input and
+ * the bias. Networks only grow from there.
+ */
+std::size_t starting_network_usage()
+{
+    NetworkDescription network;
+    int id = 1;
+    for(int i = 0; i <= NUM_INPUTS; ++i)
+    {
+        network.push_back({id++, i < NUM_INPUTS ? NeuronType::INPUT : NeuronType::BIAS, 1.0, {}});
+    }
+    for(int i = 0; i < NUM_OUTPUTS; ++i)
+    {
+        NeuronDescription output{id++, NeuronType::OUTPUT, 1.0, {}};
+        for(int source = 1; source <= NUM_INPUTS + 1; ++source)
+        {
+            output.in_links.push_back({source, output.id, 0.0});
+        }
+        network.push_back(std::move(output));
+    }
+    return memory_usage(network);
+}
+
+}
+
+
+std::string& SharedBuffer::next()
+{
+    m_current = nullptr;
+    for(auto& buffer : m_buffers)
+    {
+        if(buffer.use_count() == 1)
+        {
+            m_current = buffer;
+            break;
+        }
+    }
+
+    if(m_current)
+    {
+        // pairs with the release of the push server dropping its reference, its reads happen before the writes
+        std::atomic_thread_fence(std::memory_order_acquire);
+    }
+    else
+    {
+        m_current = std::make_shared<std::string>();
+        m_buffers.push_back(m_current);
+    }
+
+    m_current->clear();
+    return *m_current;
+}
+
+
+const std::string& SharedBuffer::current() const
+{
+    static const std::string empty;
+    return m_current ? *m_current : empty;
+}
+
+
+std::size_t SharedBuffer::capacity() const
+{
+    std::size_t bytes = 0;
+    for(auto& buffer : m_buffers)
+    {
+        bytes += buffer->capacity();
+    }
+    return bytes;
+}
+
+
+void SharedBuffer::release()
+{
+    m_current = nullptr;
+    m_buffers.clear();
+}
+
+
+Session::Session(std::string id, const std::string& params_path, std::size_t population_size,
+                 std::size_t memory_budget, SerialExecutor& compute)
+    : id(std::move(id)),
+      population_size(population_size),
+      memory_budget(memory_budget),
+      params(params_path),
+      ga(NUM_INPUTS, NUM_OUTPUTS, params),
+      m_compute(compute),
+      m_pending(0),
+      m_ended(false)
+{
+}
+
+
+void Session::post(SerialExecutor::Job job)
+{
+    ++m_pending;
+    auto self = shared_from_this();
+    m_compute.post([self, job]()
+    {
+        --self->m_pending;
+        job();
+    });
+}
+
+
+std::size_t Session::memory_usage() const
+{
+    std::size_t bytes = history.memory_usage() + buffers.networks.memory_usage() +
+                        buffers.full.capacity() + buffers.delta.capacity() + buffers.json.capacity();
+
+    // until the first networks are handed out the population is as small as it gets
+    auto latest = history.latest();
+    if(!latest)
+    {
+        return bytes + GA_COPIES * population_size * starting_network_usage();
+    }
+    for(auto& network : latest->second)
+    {
+        bytes += GA_COPIES * tank::memory_usage(network);
+    }
+    return bytes;
+}
+
+
+void Session::account_memory()
+{
+    std::size_t usage = memory_usage();
+    {
+        std::lock_guard<std::mutex> lock(status.mutex);
+        status.memory_usage = usage;
+    }
+
+    if(memory_budget > 0 && usage > memory_budget && !m_ended.exchange(true))
+    {
+        std::cerr << "Session " << id << " holds " << usage / (1024 * 1024) << " MB, more than its budget of "
+                  << memory_budget / (1024 * 1024) << " MB, ending it" << std::endl;
+        if(on_over_budget)
+        {
+            on_over_budget(id);
+        }
+    }
+}
+
+
+SessionManager::SessionManager(std::string default_params_path, std::size_t max_sessions, std::size_t memory_budget)
+    : m_default_params_path(std::move(default_params_path)),
+      m_max_sessions(max_sessions),
+      m_memory_budget(memory_budget),
+      m_next_id(1)
+{
+}
+
+
+SessionManager::~SessionManager()
+{
+    // the jobs queued so far may still end a session, they have to run while the map is there
+    std::promise<void> idle;
+    m_compute.post([&idle]() { idle.set_value(); });
+    idle.get_future().wait();
+
+    // the sessions post their deletions, the executor runs them before it is destroyed
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_sessions.clear();
+}
+
+
+std::shared_ptr<Session> SessionManager::create(const std::string& id, const nlohmann::json& overrides, bool limited)
+{
+    if(!overrides.is_object())
+    {
+        throw std::invalid_argument("Session parameters must be a JSON object");
+    }
+
+    nlohmann::json params;
+    {
+        std::ifstream ifs(m_default_params_path);
+        params = nlohmann::json::parse(ifs);
+    }
+
+    for(auto it = overrides.begin(); it != overrides.end(); ++it)
+    {
+        auto default_value = params.find(it.key());
+        if(default_value == params.end())
+        {
+            throw std::invalid_argument("Unknown parameter: " + it.key());
+        }
+        if(!same_kind(it.value(), *default_value))
+        {
+            throw std::invalid_argument("Parameter " + it.key() + " must be " + kind_of(*default_value) + ", not " +
+                                        kind_of(it.value()));
+        }
+        params[it.key()] = it.value();
+    }
+
+    for(auto it = params.begin(); it != params.end(); ++it)
+    {
+        if(it.value().is_number_integer() && it.value().get<long long>() < 0)
+        {
+            throw std::invalid_argument("Parameter " + it.key() + " must not be negative");
+        }
+        auto cap = PARAMETER_CAPS.find(it.key());
+        if(cap != PARAMETER_CAPS.end() && it.value().is_number_integer() && it.value().get<long long>() > cap->second)
+        {
+            throw std::invalid_argument("Parameter " + it.key() + " must not be above " + std::to_string(cap->second));
+        }
+    }
+
+    auto& population = params["PopulationSize"];
+    if(!population.is_number_integer() || population.get<long long>() == 0)
+    {
+        throw std::invalid_argument("PopulationSize must be a positive integer");
+    }
+
+    // the genetic algorithm and the first generation handed out, before the networks grow any further
+    std::size_t population_size = population.get<std::size_t>();
+    std::size_t memory_budget = limited ? m_memory_budget : 0;
+    std::size_t starting_usage = (Session::GA_COPIES + 1) * population_size * starting_network_usage();
+    if(memory_budget > 0 && starting_usage > memory_budget)
+    {
+        throw std::invalid_argument("A population of " + std::to_string(population_size) + " starts out at " +
+                                    std::to_string(starting_usage / 1024) + " KB, more than the session budget of " +
+                                    std::to_string(memory_budget / 1024) + " KB");
+    }
+
+    std::string session_id = id;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        while(session_id.empty() || (id.empty() && m_sessions.count(session_id) > 0))
+        {
+            session_id = "s" + std::to_string(m_next_id++);
+        }
+        check_can_add(session_id);
+    }
+
+    // neat::Params only reads from a file, hand it the merged parameters through a temporary one
+    TemporaryFile params_file(boost::filesystem::temp_directory_path() /
+                              boost::filesystem::unique_path("tank-params-%%%%-%%%%-%%%%.json"));
+    {
+        std::ofstream ofs(params_file.path().string());
+        ofs << params.dump();
+    }
+
+    // the population is built on the executor, no genetic algorithm is touched while another one runs an epoch
+    std::promise<Session*> built;
+    std::string params_path = params_file.path().string();
+    m_compute.post([&]()
+    {
+        try
+        {
+            built.set_value(new Session(session_id, params_path, population_size, memory_budget, m_compute));
+        }
+        catch(...)
+        {
+            built.set_exception(std::current_exception());
+        }
+    });
+
+    // the last reference lets go of the session on any thread, it is destroyed on the executor
+    SerialExecutor* compute = &m_compute;
+    std::shared_ptr<Session> session(built.get_future().get(), [compute](Session* session)
+    {
+        compute->post([session]() { delete session; });
+    });
+    session->on_over_budget = [this](const std::string& id) { remove(id); };
+
+    // the checks are repeated in case another session got in while the population was built
+    std::lock_guard<std::mutex> lock(m_mutex);
+    check_can_add(session_id);
+    m_sessions.emplace(session_id, session);
+    return session;
+}
+
+
+void SessionManager::check_can_add(const std::string& id) const
+{
+    if(m_max_sessions > 0 && m_sessions.size() >= m_max_sessions)
+    {
+        throw std::runtime_error("No more than " + std::to_string(m_max_sessions) + " sessions can run at once");
+    }
+
+    if(m_sessions.count(id) > 0)
+    {
+        throw std::invalid_argument("Session " + id + " already exists");
+    }
+}
+
+
+std::shared_ptr<Session> SessionManager::find(const std::string& id) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_sessions.find(id);
+    return it == m_sessions.end() ? nullptr : it->second;
+}
+
+
+bool SessionManager::remove(const std::string& id)
+{
+    std::shared_ptr<Session> session;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_sessions.find(id);
+        if(it == m_sessions.end())
+        {
+            return false;
+        }
+        session = std::move(it->second);
+        m_sessions.erase(it);
+    }
+
+    // its queued jobs hold on to it, the last reference posts its deletion after them
+    session.reset();
+    return true;
+}
+
+
+std::vector<std::shared_ptr<Session>> SessionManager::sessions() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<std::shared_ptr<Session>> sessions;
+    for(auto& entry : m_sessions)
+    {
+        sessions.push_back(entry.second);
+    }
+    return sessions;
+}
+
+}
@@ -0,0 +1,86 @@
+#include <algorithm>
+
+#include "batched_brain.h"
+#include "bot.h"
+#include "simulation.h"
+
+
+namespace tank
+{
+
+Simulation::Simulation(World world, TaskPool& pool, int frames)
+    : m_world(std::move(world)),
+      m_pool(pool),
+      m_frames(frames)
+{
+}
+
+
+std::vector<double> Simulation::evaluate(const std::vector<NetworkDescription>& networks) const
+{
+    // full groups use the SIMD lanes best, but a small population needs smaller groups to keep every thread busy
+    std::size_t per_thread = (networks.size() + m_pool.size() - 1) / m_pool.size();
+    std::size_t lanes = std::max<std::size_t>(1, std::min<std::size_t>(BatchedBrain::LANES, per_thread));
+    std::size_t num_groups = (networks.size() + lanes - 1) / lanes;
+
+    std::vector<double> fitnesses(networks.size(), 0.0);
+    m_pool.parallel_for(num_groups, [this, &networks, &fitnesses, lanes](std::size_t group)
+    {
+        std::size_t begin = group * lanes;
+        std::size_t end = std::min(begin + lanes, networks.size());
+        evaluate_group(networks, begin, end, fitnesses);
+    });
+    return fitnesses;
+}
+
+
+double Simulation::evaluate(const NetworkDescription& network) const
+{
+    Brain brain(network);
+    Bot bot(m_world);
+    for(int frame = 0; frame < m_frames; ++frame)
+    {
+        bot.update(brain, m_world);
+    }
+    return bot.memory_map().get_num_cells_visited();
+}
+
+
+void Simulation::evaluate_group(const std::vector<NetworkDescription>& networks,
+                                std::size_t begin,
+                                std::size_t end,
+                                std::vector<double>& fitnesses) const
+{
+    std::vector<std::shared_ptr<const CompiledNetwork>> compiled;
+    std::vector<Bot> bots;
+    for(std::size_t i = begin; i < end; ++i)
+    {
+        compiled.push_back(std::make_shared<const CompiledNetwork>(compile_network(networks[i])));
+        bots.emplace_back(m_world);
+    }
+
+    BatchedBrain brain(compiled);
+    std::vector<BrainInput> inputs(bots.size());
+    std::vector<BrainOutput> outputs(bots.size());
+    for(int frame = 0; frame < m_frames; ++frame)
+    {
+        for(std::size_t b = 0; b < bots.size(); ++b)
+        {
+            inputs[b] = bots[b].sense(m_world);
+        }
+
+        brain.update(inputs.data(), outputs.data());
+
+        for(std::size_t b = 0; b < bots.size(); ++b)
+        {
+            bots[b].act(outputs[b], m_world);
+        }
+    }
+
+    for(std::size_t b = 0; b < bots.size(); ++b)
+    {
+        fitnesses[begin + b] = bots[b].memory_map().get_num_cells_visited();
+    }
+}
+
+}
@@ -0,0 +1,313 @@
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+
+#include <boost/algorithm/string.hpp>
+#include <boost/filesystem.hpp>
+
+#include "compression.h"
+#include "content_hash.h"
+#include "static_file_cache.h"
+
+
+namespace tank
+{
+
+namespace fs = boost::filesystem;
+
+namespace
+{
+
+bool is_compressible(const std::string& content_type)
+{
+    return boost::starts_with(content_type, "text/") || boost::starts_with(content_type, "application/javascript") ||
+           content_type == "application/json" || content_type == "image/svg+xml";
+}
+
+
+/**
+ * Quality value the Accept-Encoding header value gives to the coding, 0 if it is not acceptable.
+ */
+float accepted_quality(const std::string& accept_encoding, const std::string& coding)
+{
+    float wildcard = 0.0f;
+    std::vector<std::string> items;
+    boost::split(items, accept_encoding, boost::is_any_of(","));
+    for(auto& item : items)
+    {
+        std::vector<std::string> parts;
+        boost::split(parts, item, boost::is_any_of(";"));
+
+        std::string name = boost::trim_copy(parts[0]);
+        float quality = 1.0f;
+        for(std::size_t i = 1; i < parts.size(); ++i)
+        {
+            std::string parameter = boost::trim_copy(parts[i]);
+            if(boost::istarts_with(parameter, "q="))
+            {
+                quality = std::strtof(parameter.c_str() + 2, nullptr);
+            }
+        }
+
+        if(boost::iequals(name, coding))
+        {
+            return quality;
+        }
+        if(name == "*")
+        {
+            wildcard = quality;
+        }
+    }
+    return wildcard;
+}
+
+}
+
+
+const FileRepresentation& CachedFile::select(const std::string* accept_encoding) const
+{
+    const FileRepresentation* best = &representations.front();
+    if(!accept_encoding)
+    {
+        return *best;
+    }
+
+    for(auto& representation : representations)
+    {
+        if(!representation.encoding.empty() && representation.body.size() < best->body.size() &&
+           accepted_quality(*accept_encoding, representation.encoding) > 0.0f)
+        {
+            best = &representation;
+        }
+    }
+    return *best;
+}
+
+
+StaticFileCache::StaticFileCache(const std::string& root, std::uintmax_t max_file_size, bool precompress,
+                                 std::chrono::milliseconds refresh_period)
+    : m_root(fs::canonical(root).string()),
+      m_max_file_size(max_file_size),
+      m_precompress(precompress),
+      m_refresh_period(refresh_period),
+      m_files(std::make_shared<Files>()),
+      m_stop(false)
+{
+    refresh();
+    m_refresher = std::thread(&StaticFileCache::refresh_loop, this);
+}
+
+
+StaticFileCache::~StaticFileCache()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_stop_mutex);
+        m_stop = true;
+    }
+    m_stop_signal.notify_one();
+    m_refresher.join();
+}
+
+
+std::shared_ptr<const CachedFile> StaticFileCache::find(const std::string& request_path) const
+{
+    std::string path = request_path.substr(0, request_path.find('?'));
+    if(path.empty() || path.back() == '/')
+    {
+        path += "index.html";
+    }
+
+    std::shared_ptr<const Files> files;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        files = m_files;
+    }
+
+    auto it = files->find(path);
+    if(it == files->end())
+    {
+        // a directory requested without the trailing slash
+        it = files->find(path + "/index.html");
+    }
+    return it != files->end() ? it->second : nullptr;
+}
+
+
+std::string StaticFileCache::content_type(const std::string& path)
+{
+    static const std::map<std::string, std::string> types = {
+        {".html", "text/html; charset=utf-8"},
+        {".js", "application/javascript; charset=utf-8"},
+        {".css", "text/css; charset=utf-8"},
+        {".json", "application/json"},
+        {".png", "image/png"},
+        {".jpg", "image/jpeg"},
+        {".svg", "image/svg+xml"},
+        {".ico", "image/x-icon"}
+    };
+
+    auto it = types.find(fs::path(path).extension().string());
+    return it != types.end() ? it->second : "application/octet-stream";
+}
+
+
+bool StaticFileCache::etag_matches(const std::string& if_none_match, const std::string& etag)
+{
+    std::vector<std::string> tags;
+    boost::split(tags, if_none_match, boost::is_any_of(","));
+    for(auto& tag : tags)
+    {
+        boost::trim(tag);
+        // weak comparison, as If-None-Match asks for
+        if(boost::starts_with(tag, "W/"))
+        {
+            tag.erase(0, 2);
+        }
+        if(tag == "*" || tag == etag)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+FileRepresentation StaticFileCache::make_representation(const std::string& key, std::string encoding,
+                                                        std::string body) const
+{
+    FileRepresentation representation;
+    representation.encoding = std::move(encoding);
+    representation.body = std::move(body);
+
+    std::stringstream etag;
+    etag << "\"" << std::hex << content_hash(representation.body);
+    if(!representation.encoding.empty())
+    {
+        etag << "-" << representation.encoding;
+    }
+    etag << "\"";
+    representation.etag = etag.str();
+
+    std::stringstream validators;
+    if(m_precompress)
+    {
+        validators << "ETag: " << representation.etag << "\r\n"
+                   << "Cache-Control: no-cache\r\n"
+                   << "Vary: Accept-Encoding\r\n";
+    }
+    else
+    {
+        validators << "Cache-Control: no-cache, no-store, must_revalidate\r\nPragma: no-cache\r\nExpires: 0\r\n";
+    }
+
+    std::stringstream header;
+    header << "HTTP/1.1 200 OK\r\n"
+           << "Content-Type: " << content_type(key) << "\r\n";
+    if(!representation.encoding.empty())
+    {
+        header << "Content-Encoding: " << representation.encoding << "\r\n";
+    }
+    header << validators.str()
+           << "Content-Length: " << representation.body.size() << "\r\n\r\n";
+    representation.header = header.str();
+
+    representation.not_modified_header = "HTTP/1.1 304 Not Modified\r\n" + validators.str() + "\r\n";
+    return representation;
+}
+
+
+void StaticFileCache::refresh()
+{
+    std::shared_ptr<const Files> old_files;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        old_files = m_files;
+    }
+
+    auto files = std::make_shared<Files>();
+    bool changed = false;
+    try
+    {
+        for(fs::recursive_directory_iterator it(m_root), end; it != end; ++it)
+        {
+            if(!fs::is_regular_file(it->status()))
+            {
+                continue;
+            }
+
+            std::uintmax_t size = fs::file_size(it->path());
+            if(size > m_max_file_size)
+            {
+                continue;
+            }
+
+            std::string key = it->path().string().substr(m_root.size());
+            std::time_t last_write_time = fs::last_write_time(it->path());
+
+            auto old = old_files->find(key);
+            // modification times have a one second resolution, the size catches most edits within the same second
+            if(old != old_files->end() && old->second->last_write_time == last_write_time &&
+               old->second->size == size)
+            {
+                (*files)[key] = old->second;
+                continue;
+            }
+
+            std::ifstream ifs(it->path().string(), std::ios::binary);
+            if(!ifs)
+            {
+                continue;
+            }
+
+            std::string body(std::istreambuf_iterator<char>(ifs), {});
+
+            std::vector<FileRepresentation> encoded;
+            if(m_precompress && is_compressible(content_type(key)))
+            {
+                encoded.push_back(make_representation(key, "gzip", gzip_compress(body)));
+                if(brotli_available())
+                {
+                    encoded.push_back(make_representation(key, "br", brotli_compress(body)));
+                }
+            }
+
+            auto file = std::make_shared<CachedFile>();
+            file->last_write_time = last_write_time;
+            file->size = size;
+            file->representations.push_back(make_representation(key, "", std::move(body)));
+            std::move(encoded.begin(), encoded.end(), std::back_inserter(file->representations));
+
+            (*files)[key] = std::move(file);
+            changed = true;
+        }
+    }
+    catch(const std::exception& e)
+    {
+        // a file went away halfway through the scan, the next one picks up where things settled
+        std::cerr << "Static file cache refresh failed: " << e.what() << std::endl;
+        return;
+    }
+
+    if(changed || files->size() != old_files->size())
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_files = std::move(files);
+    }
+}
+
+
+void StaticFileCache::refresh_loop()
+{
+    std::unique_lock<std::mutex> lock(m_stop_mutex);
+    while(!m_stop_signal.wait_for(lock, m_refresh_period, [this]() { return m_stop; }))
+    {
+        lock.unlock();
+        refresh();
+        lock.lock();
+    }
+}
+
+}
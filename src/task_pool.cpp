@@ -0,0 +1,173 @@
+#include <algorithm>
+#include <exception>
+
+#include "task_pool.h"
+
+
+namespace tank
+{
+
+TaskPool::TaskPool(unsigned num_threads)
+    : m_pending(0),
+      m_stop(false)
+{
+    num_threads = std::max(1u, num_threads);
+    for(unsigned i = 0; i < num_threads; ++i)
+    {
+        m_queues.emplace_back(new Queue());
+    }
+
+    for(unsigned i = 0; i < num_threads; ++i)
+    {
+        m_threads.emplace_back(&TaskPool::worker_loop, this, i);
+    }
+}
+
+
+TaskPool::~TaskPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_wake_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+
+    for(auto& thread : m_threads)
+    {
+        thread.join();
+    }
+}
+
+
+unsigned TaskPool::default_thread_count()
+{
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+
+void TaskPool::parallel_for(std::size_t count, const std::function<void(std::size_t)>& body)
+{
+    if(count == 0)
+    {
+        return;
+    }
+
+    struct Batch
+    {
+        std::atomic<std::size_t> remaining;
+        std::mutex mutex;
+        std::condition_variable done;
+        std::exception_ptr error;
+    };
+
+    auto batch = std::make_shared<Batch>();
+    batch->remaining = count;
+
+    // Hand every worker a contiguous block up front, stealing evens out whatever imbalance is left
+    std::size_t num_queues = m_queues.size();
+    for(std::size_t q = 0; q < num_queues; ++q)
+    {
+        std::size_t begin = count * q / num_queues;
+        std::size_t end = count * (q + 1) / num_queues;
+
+        std::lock_guard<std::mutex> lock(m_queues[q]->mutex);
+        for(std::size_t i = begin; i < end; ++i)
+        {
+            m_queues[q]->tasks.emplace_back([batch, &body, i]()
+            {
+                try
+                {
+                    body(i);
+                }
+                catch(...)
+                {
+                    std::lock_guard<std::mutex> lock(batch->mutex);
+                    if(!batch->error)
+                    {
+                        batch->error = std::current_exception();
+                    }
+                }
+
+                if(--batch->remaining == 0)
+                {
+                    std::lock_guard<std::mutex> lock(batch->mutex);
+                    batch->done.notify_all();
+                }
+            });
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_wake_mutex);
+        m_pending += static_cast<long>(count);
+    }
+    m_wake.notify_all();
+
+    // Help out instead of sleeping while there is still work queued
+    Task task;
+    while(batch->remaining > 0 && take_task(0, task))
+    {
+        task();
+    }
+
+    std::unique_lock<std::mutex> lock(batch->mutex);
+    batch->done.wait(lock, [&batch]() { return batch->remaining == 0; });
+
+    if(batch->error)
+    {
+        std::rethrow_exception(batch->error);
+    }
+}
+
+
+void TaskPool::worker_loop(unsigned index)
+{
+    Task task;
+    while(true)
+    {
+        if(take_task(index, task))
+        {
+            task();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_wake_mutex);
+        m_wake.wait(lock, [this]() { return m_stop || m_pending > 0; });
+        if(m_stop)
+        {
+            return;
+        }
+    }
+}
+
+
+bool TaskPool::take_task(unsigned index, Task& task)
+{
+    {
+        auto& own = *m_queues[index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if(!own.tasks.empty())
+        {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            --m_pending;
+            return true;
+        }
+    }
+
+    for(std::size_t offset = 1; offset < m_queues.size(); ++offset)
+    {
+        auto& victim = *m_queues[(index + offset) % m_queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if(!victim.tasks.empty())
+        {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            --m_pending;
+            return true;
+        }
+    }
+    return false;
+}
+
+}
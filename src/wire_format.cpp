@@ -0,0 +1,594 @@
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <unordered_map>
+
+#include "content_hash.h"
+#include "wire_format.h"
+
+
+namespace tank
+{
+
+namespace
+{
+
+class WireWriter
+{
+public:
+    /**
+     * Writes a bare piece of a message, without the header.
+     */
+    explicit WireWriter(std::string& buffer)
+        : m_buffer(buffer)
+    {
+        m_buffer.clear();
+    }
+
+    WireWriter(WireMessage kind, std::string& buffer)
+        : m_buffer(buffer)
+    {
+        m_buffer.clear();
+        m_buffer.append("TNK");
+        put_u8(WIRE_VERSION);
+        put_u8(static_cast<std::uint8_t>(kind));
+    }
+
+    void put_u8(std::uint8_t value)
+    {
+        m_buffer.push_back(static_cast<char>(value));
+    }
+
+    void put_varint(std::uint64_t value)
+    {
+        while(value >= 0x80)
+        {
+            put_u8(static_cast<std::uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        put_u8(static_cast<std::uint8_t>(value));
+    }
+
+    void put_zigzag(std::int64_t value)
+    {
+        put_varint((static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63));
+    }
+
+    void put_f32(float value)
+    {
+        std::uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        for(int i = 0; i < 4; ++i)
+        {
+            put_u8(static_cast<std::uint8_t>(bits >> (8 * i)));
+        }
+    }
+
+    void put_f64(double value)
+    {
+        std::uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        for(int i = 0; i < 8; ++i)
+        {
+            put_u8(static_cast<std::uint8_t>(bits >> (8 * i)));
+        }
+    }
+
+    void put_networks(const CachedNetworks& networks)
+    {
+        put_varint(networks.size());
+        for(auto& network : networks)
+        {
+            m_buffer.append(network->wire());
+        }
+    }
+
+    void put_network(const NetworkDescription& network)
+    {
+        put_varint(network.size());
+        for(auto& neuron : network)
+        {
+            put_neuron(neuron);
+        }
+    }
+
+    void put_neuron(const NeuronDescription& neuron)
+    {
+        put_u8(static_cast<std::uint8_t>(neuron.type));
+        put_zigzag(neuron.id);
+        put_f32(static_cast<float>(neuron.activation_response));
+
+        put_varint(neuron.in_links.size());
+        for(auto& link : neuron.in_links)
+        {
+            put_zigzag(link.input_id);
+            put_f32(static_cast<float>(link.weight));
+        }
+    }
+
+    void put_summary(const GenerationSummary& summary)
+    {
+        put_varint(summary.generation);
+        put_zigzag(summary.best_species_id);
+        put_f64(summary.best_so_far);
+
+        put_f64(summary.stats_mean);
+        put_f64(summary.stats_std);
+        put_f64(summary.stats_min);
+        put_f64(summary.stats_max);
+        put_f64(summary.stats_current);
+
+        put_varint(summary.species.size());
+        for(auto& species : summary.species)
+        {
+            put_zigzag(species.first);
+            put_f64(species.second);
+        }
+    }
+
+private:
+    std::string& m_buffer;
+};
+
+
+class WireReader
+{
+public:
+    WireReader(WireMessage kind, const char* data, std::size_t size)
+        : m_data(data),
+          m_end(data + size)
+    {
+        if(size < 5 || std::memcmp(data, "TNK", 3) != 0)
+        {
+            throw std::invalid_argument("Not a wire format message");
+        }
+        m_data += 3;
+        if(get_u8() != WIRE_VERSION)
+        {
+            throw std::invalid_argument("Unsupported wire format version");
+        }
+        if(get_u8() != static_cast<std::uint8_t>(kind))
+        {
+            throw std::invalid_argument("Unexpected wire format message");
+        }
+    }
+
+    std::uint8_t get_u8()
+    {
+        need(1);
+        return static_cast<std::uint8_t>(*m_data++);
+    }
+
+    std::uint64_t get_varint()
+    {
+        std::uint64_t value = 0;
+        for(int shift = 0; shift < 64; shift += 7)
+        {
+            std::uint8_t byte = get_u8();
+            value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+            if(!(byte & 0x80))
+            {
+                return value;
+            }
+        }
+        throw std::invalid_argument("Malformed varint");
+    }
+
+    std::int64_t get_zigzag()
+    {
+        std::uint64_t value = get_varint();
+        return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+    }
+
+    float get_f32()
+    {
+        need(4);
+        std::uint32_t bits = 0;
+        for(int i = 0; i < 4; ++i)
+        {
+            bits |= static_cast<std::uint32_t>(static_cast<std::uint8_t>(*m_data++)) << (8 * i);
+        }
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    double get_f64()
+    {
+        need(8);
+        std::uint64_t bits = 0;
+        for(int i = 0; i < 8; ++i)
+        {
+            bits |= static_cast<std::uint64_t>(static_cast<std::uint8_t>(*m_data++)) << (8 * i);
+        }
+        double value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    /**
+     * A count of items that take at least min_item_size bytes each, checked against what is left of the message.
+     */
+    std::size_t get_count(std::size_t min_item_size)
+    {
+        std::uint64_t count = get_varint();
+        if(count > static_cast<std::uint64_t>(m_end - m_data) / min_item_size)
+        {
+            throw std::invalid_argument("Wire format count exceeds the message");
+        }
+        return static_cast<std::size_t>(count);
+    }
+
+    std::vector<NetworkDescription> get_networks()
+    {
+        std::vector<NetworkDescription> networks(get_count(1));
+        for(auto& network : networks)
+        {
+            network.resize(get_count(7));
+            for(auto& neuron : network)
+            {
+                std::uint8_t type = get_u8();
+                if(type > static_cast<std::uint8_t>(NeuronType::OUTPUT))
+                {
+                    throw std::invalid_argument("Unknown neuron type");
+                }
+                neuron.type = static_cast<NeuronType>(type);
+                neuron.id = static_cast<int>(get_zigzag());
+                neuron.activation_response = get_f32();
+
+                neuron.in_links.resize(get_count(5));
+                for(auto& link : neuron.in_links)
+                {
+                    link.input_id = static_cast<int>(get_zigzag());
+                    link.output_id = neuron.id;
+                    link.weight = get_f32();
+                }
+            }
+        }
+        return networks;
+    }
+
+    void finish() const
+    {
+        if(m_data != m_end)
+        {
+            throw std::invalid_argument("Trailing bytes after wire format message");
+        }
+    }
+
+private:
+    void need(std::size_t bytes) const
+    {
+        if(static_cast<std::size_t>(m_end - m_data) < bytes)
+        {
+            throw std::invalid_argument("Truncated wire format message");
+        }
+    }
+
+    const char* m_data;
+    const char* m_end;
+};
+
+
+/**
+ * Type, id and inputs of a neuron - what has to match for its weights to be patched in place.
+ */
+bool same_wiring(const NeuronDescription& a, const NeuronDescription& b)
+{
+    if(a.type != b.type || a.id != b.id || a.in_links.size() != b.in_links.size())
+    {
+        return false;
+    }
+
+    for(std::size_t l = 0; l < a.in_links.size(); ++l)
+    {
+        if(a.in_links[l].input_id != b.in_links[l].input_id)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+/**
+ * Hashes of the wiring of every neuron, in network order.
+ */
+std::vector<std::uint64_t> neuron_signatures(const NetworkDescription& network)
+{
+    std::vector<std::uint64_t> signatures;
+    signatures.reserve(network.size());
+
+    std::vector<int> wiring;
+    for(auto& neuron : network)
+    {
+        wiring.assign({static_cast<int>(neuron.type), neuron.id});
+        for(auto& link : neuron.in_links)
+        {
+            wiring.push_back(link.input_id);
+        }
+        signatures.push_back(content_hash(reinterpret_cast<const char*>(wiring.data()), wiring.size() * sizeof(int)));
+    }
+    return signatures;
+}
+
+
+std::uint64_t structure_hash(const std::vector<std::uint64_t>& signatures)
+{
+    return content_hash(reinterpret_cast<const char*>(signatures.data()), signatures.size() * sizeof(std::uint64_t));
+}
+
+
+std::vector<std::uint64_t> sorted(std::vector<std::uint64_t> signatures)
+{
+    std::sort(signatures.begin(), signatures.end());
+    return signatures;
+}
+
+
+/**
+ * Number of neuron signatures two networks have in common, both given sorted.
+ */
+std::size_t count_shared(const std::vector<std::uint64_t>& a, const std::vector<std::uint64_t>& b)
+{
+    std::size_t shared = 0;
+    auto i = a.begin();
+    auto j = b.begin();
+    while(i != a.end() && j != b.end())
+    {
+        if(*i < *j)
+        {
+            ++i;
+        }
+        else if(*j < *i)
+        {
+            ++j;
+        }
+        else
+        {
+            ++shared;
+            ++i;
+            ++j;
+        }
+    }
+    return shared;
+}
+
+}
+
+
+void encode_network(const NetworkDescription& network, std::string& out)
+{
+    WireWriter writer(out);
+    writer.put_network(network);
+}
+
+
+void encode_population(int generation, const CachedNetworks& networks, std::string& out)
+{
+    WireWriter writer(WireMessage::POPULATION, out);
+    writer.put_varint(generation);
+    writer.put_networks(networks);
+}
+
+
+void encode_generation(const GenerationSummary& summary, const CachedNetworks& networks, std::string& out)
+{
+    WireWriter writer(WireMessage::GENERATION, out);
+    writer.put_summary(summary);
+    writer.put_networks(networks);
+}
+
+
+void encode_generation_delta(const GenerationSummary& summary, const std::vector<NetworkDescription>& networks,
+                             int base_generation, const std::vector<NetworkDescription>& base_networks,
+                             std::string& out)
+{
+    WireWriter writer(WireMessage::GENERATION_DELTA, out);
+    writer.put_summary(summary);
+    writer.put_varint(base_generation);
+
+    std::vector<std::vector<std::uint64_t>> base_signatures;
+    std::unordered_map<std::uint64_t, std::size_t> base_by_structure;
+    for(std::size_t b = 0; b < base_networks.size(); ++b)
+    {
+        auto signatures = neuron_signatures(base_networks[b]);
+        base_by_structure.emplace(structure_hash(signatures), b);
+        base_signatures.push_back(sorted(std::move(signatures)));
+    }
+
+    writer.put_varint(networks.size());
+    for(auto& network : networks)
+    {
+        auto signatures = neuron_signatures(network);
+
+        // an unchanged structure is the common case, only look further when there is none
+        std::size_t base = base_networks.size();
+        auto same = base_by_structure.find(structure_hash(signatures));
+        if(same != base_by_structure.end())
+        {
+            base = same->second;
+        }
+        else
+        {
+            auto sorted_signatures = sorted(signatures);
+            std::size_t best_shared = 0;
+            for(std::size_t b = 0; b < base_networks.size(); ++b)
+            {
+                std::size_t shared = count_shared(sorted_signatures, base_signatures[b]);
+                if(shared > best_shared)
+                {
+                    best_shared = shared;
+                    base = b;
+                }
+            }
+        }
+
+        if(base == base_networks.size())
+        {
+            writer.put_varint(0);
+            writer.put_network(network);
+            continue;
+        }
+
+        writer.put_varint(base + 1);
+        writer.put_varint(network.size());
+
+        std::unordered_map<int, const NeuronDescription*> base_neurons;
+        for(auto& neuron : base_networks[base])
+        {
+            base_neurons[neuron.id] = &neuron;
+        }
+
+        for(auto& neuron : network)
+        {
+            auto it = base_neurons.find(neuron.id);
+            if(it == base_neurons.end() || !same_wiring(neuron, *it->second))
+            {
+                writer.put_u8(static_cast<std::uint8_t>(DeltaOp::FULL));
+                writer.put_neuron(neuron);
+                continue;
+            }
+
+            // the client holds the float32 values, those are what has to match
+            const NeuronDescription& old = *it->second;
+            std::vector<std::size_t> changed;
+            for(std::size_t l = 0; l < neuron.in_links.size(); ++l)
+            {
+                if(static_cast<float>(neuron.in_links[l].weight) != static_cast<float>(old.in_links[l].weight))
+                {
+                    changed.push_back(l);
+                }
+            }
+
+            bool same_response = static_cast<float>(neuron.activation_response) ==
+                                 static_cast<float>(old.activation_response);
+            if(changed.empty() && same_response)
+            {
+                writer.put_u8(static_cast<std::uint8_t>(DeltaOp::KEEP));
+                writer.put_zigzag(neuron.id);
+                continue;
+            }
+
+            writer.put_u8(static_cast<std::uint8_t>(DeltaOp::PATCH));
+            writer.put_zigzag(neuron.id);
+            writer.put_f32(static_cast<float>(neuron.activation_response));
+            writer.put_varint(changed.size());
+            for(std::size_t l : changed)
+            {
+                writer.put_varint(l);
+                writer.put_f32(static_cast<float>(neuron.in_links[l].weight));
+            }
+        }
+    }
+}
+
+
+void encode_evaluation_request(std::uint64_t batch_id, int frames, const std::vector<NetworkDescription>& networks,
+                               std::string& out)
+{
+    WireWriter writer(WireMessage::EVALUATE, out);
+    writer.put_varint(batch_id);
+    writer.put_varint(frames);
+    writer.put_varint(networks.size());
+    for(auto& network : networks)
+    {
+        writer.put_network(network);
+    }
+}
+
+
+void encode_fitnesses(std::uint64_t batch_id, const std::vector<double>& fitnesses, std::string& out)
+{
+    WireWriter writer(WireMessage::FITNESSES, out);
+    writer.put_varint(batch_id);
+    writer.put_varint(fitnesses.size());
+    for(double fitness : fitnesses)
+    {
+        writer.put_f64(fitness);
+    }
+}
+
+
+EvaluationRequest decode_evaluation_request(const char* data, std::size_t size)
+{
+    WireReader reader(WireMessage::EVALUATE, data, size);
+    EvaluationRequest request;
+    request.batch_id = reader.get_varint();
+    request.frames = static_cast<int>(reader.get_varint());
+    request.networks = reader.get_networks();
+    reader.finish();
+    return request;
+}
+
+
+std::vector<double> decode_fitnesses(const char* data, std::size_t size, std::uint64_t& batch_id)
+{
+    WireReader reader(WireMessage::FITNESSES, data, size);
+    batch_id = reader.get_varint();
+    std::vector<double> fitnesses(reader.get_count(8));
+    for(double& fitness : fitnesses)
+    {
+        fitness = reader.get_f64();
+    }
+    reader.finish();
+    return fitnesses;
+}
+
+
+GenerationHistory::GenerationHistory(std::size_t max_generations)
+    : m_max_generations(max_generations)
+{
+}
+
+
+void GenerationHistory::add(int generation, std::vector<NetworkDescription> networks)
+{
+    m_generations.erase(std::remove_if(m_generations.begin(), m_generations.end(),
+                                       [generation](const std::pair<int, std::vector<NetworkDescription>>& entry)
+                                       {
+                                           return entry.first == generation;
+                                       }),
+                        m_generations.end());
+    m_generations.emplace_back(generation, std::move(networks));
+    while(m_generations.size() > m_max_generations)
+    {
+        m_generations.pop_front();
+    }
+}
+
+
+const std::vector<NetworkDescription>* GenerationHistory::find(int generation) const
+{
+    for(auto& entry : m_generations)
+    {
+        if(entry.first == generation)
+        {
+            return &entry.second;
+        }
+    }
+    return nullptr;
+}
+
+
+const std::pair<int, std::vector<NetworkDescription>>* GenerationHistory::latest() const
+{
+    return m_generations.empty() ? nullptr : &m_generations.back();
+}
+
+
+std::size_t GenerationHistory::memory_usage() const
+{
+    std::size_t bytes = 0;
+    for(auto& entry : m_generations)
+    {
+        bytes += entry.second.capacity() * sizeof(NetworkDescription);
+        for(auto& network : entry.second)
+        {
+            bytes += tank::memory_usage(network);
+        }
+    }
+    return bytes;
+}
+
+}
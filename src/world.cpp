@@ -0,0 +1,37 @@
+#include "world.h"
+
+
+namespace tank
+{
+
+World::World(float width, float height, std::vector<Polygon> obstacles)
+    : m_width(width),
+      m_height(height),
+      m_obstacles(std::move(obstacles)),
+      m_segments(m_obstacles),
+      m_grid(m_obstacles, width, height, CELL_SIZE, SENSOR_RANGE)
+{
+}
+
+
+World World::default_world()
+{
+    Polygon triangle = {{200, 200}, {300, 300}, {200, 300}, {200, 200}};
+    Polygon square1 = {{500, 520}, {500, 650}, {700, 650}, {700, 520}, {500, 520}};
+    Polygon square2 = {{800, 520}, {800, 650}, {1000, 650}, {1000, 520}, {800, 520}};
+    Polygon octagon = {{600, 150}, {1000, 150}, {1100, 250}, {1100, 350},
+                       {1000, 450}, {600, 450}, {500, 350}, {500, 250}, {600, 150}};
+    Polygon rectangle = {{150, 400}, {330, 400}, {330, 650}, {150, 650}, {150, 400}};
+    Polygon walls = {{45, 45}, {1180, 45}, {1180, 755}, {45, 755}, {45, 45}};
+
+    return World(WORLD_WIDTH, WORLD_HEIGHT, {triangle, square1, square2, octagon, rectangle, walls});
+}
+
+
+void World::cast_sensors(Vec2 origin, const SensorArray& ends, SensorDepths& depths) const
+{
+    auto cell = m_grid.query(origin);
+    (cell != nullptr ? *cell : m_segments).cast(origin, ends, depths);
+}
+
+}
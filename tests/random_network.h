@@ -0,0 +1,54 @@
+#ifndef TANK_TESTS_RANDOM_NETWORK_H
+#define TANK_TESTS_RANDOM_NETWORK_H
+
+#include <random>
+
+#include "consts.h"
+#include "network.h"
+
+
+namespace tank
+{
+
+/**
+ * A network laid out the way neat::NeuralNet::serialize() emits one - the inputs, the bias, the hidden neurons and
+ * the outputs last - with up to max_hidden hidden neurons. Links come from any neuron, later ones and the neuron
+ * itself included, so there are recurrent links, and a neuron may read the same source more than once.
+ */
+inline NetworkDescription random_network(std::mt19937& random, int max_hidden = 6)
+{
+    std::uniform_int_distribution<int> num_hidden(0, max_hidden);
+    std::uniform_real_distribution<double> weight(-3.0, 3.0);
+    std::uniform_real_distribution<double> activation_response(0.5, 1.5);
+
+    NetworkDescription network;
+    int id = 1;
+    for(int i = 0; i < NUM_INPUTS; ++i)
+    {
+        network.push_back({id++, NeuronType::INPUT, 1.0, {}});
+    }
+    network.push_back({id++, NeuronType::BIAS, 1.0, {}});
+    for(int i = num_hidden(random); i > 0; --i)
+    {
+        network.push_back({id++, NeuronType::HIDDEN, activation_response(random), {}});
+    }
+    for(int i = 0; i < NUM_OUTPUTS; ++i)
+    {
+        network.push_back({id++, NeuronType::OUTPUT, activation_response(random), {}});
+    }
+
+    std::uniform_int_distribution<std::size_t> source(0, network.size() - 1);
+    std::uniform_int_distribution<int> num_links(0, 8);
+    for(std::size_t i = NUM_INPUTS + 1; i < network.size(); ++i)
+    {
+        for(int l = num_links(random); l > 0; --l)
+        {
+            network[i].in_links.push_back({network[source(random)].id, network[i].id, weight(random)});
+        }
+    }
+    return network;
+}
+
+}
+
+#endif
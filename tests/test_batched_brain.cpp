@@ -0,0 +1,78 @@
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "batched_brain.h"
+#include "brain.h"
+#include "random_network.h"
+
+
+/**
+ * Runs random networks, recurrent and duplicate links included, through BatchedBrain in groups of every size and
+ * through one Brain each, feeding both the same random inputs frame after frame. The outputs have to match bit for
+ * bit.
+ */
+
+namespace
+{
+
+const int NUM_GROUPS = 400;
+const int FRAMES = 50;
+
+}
+
+
+int main()
+{
+    std::mt19937 random(4321);
+    std::uniform_real_distribution<float> reading(-1.0f, 1.0f);
+    std::uniform_int_distribution<int> group_size(1, tank::BatchedBrain::LANES);
+
+    long compared = 0;
+    long mismatched = 0;
+    for(int group = 0; group < NUM_GROUPS; ++group)
+    {
+        std::vector<std::shared_ptr<const tank::CompiledNetwork>> compiled;
+        std::vector<tank::Brain> brains;
+        for(int lane = group_size(random); lane > 0; --lane)
+        {
+            compiled.push_back(std::make_shared<const tank::CompiledNetwork>(
+                tank::compile_network(tank::random_network(random))));
+            brains.emplace_back(compiled.back());
+        }
+
+        tank::BatchedBrain batched(compiled);
+        std::vector<tank::BrainInput> inputs(compiled.size());
+        std::vector<tank::BrainOutput> outputs(compiled.size());
+        for(int frame = 0; frame < FRAMES; ++frame)
+        {
+            for(auto& input : inputs)
+            {
+                for(auto& value : input)
+                {
+                    value = reading(random);
+                }
+            }
+
+            batched.update(inputs.data(), outputs.data());
+            for(std::size_t lane = 0; lane < brains.size(); ++lane)
+            {
+                auto expected = brains[lane].update(inputs[lane]);
+                ++compared;
+                if(std::memcmp(expected.data(), outputs[lane].data(), sizeof(expected)) != 0 && mismatched++ < 10)
+                {
+                    std::cerr << std::setprecision(9) << "Lane " << lane << " of group " << group
+                              << " differs in frame " << frame << ": " << outputs[lane][0] << ", " << outputs[lane][1]
+                              << " instead of " << expected[0] << ", " << expected[1] << std::endl;
+                }
+            }
+        }
+    }
+
+    std::cout << compared - mismatched << " of " << compared << " outputs match" << std::endl;
+    return mismatched == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,123 @@
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <limits>
+
+#include "brain.h"
+#include "fast_sigmoid.h"
+
+
+/**
+ * Sweeps [-20, 20] in steps of 2^-16 and the extremes, checking fast_sigmoid against the sigmoid in double precision
+ * within the bound stated in fast_sigmoid.h, and that the scalar, SIMD and Brain paths return the same values.
+ */
+
+namespace
+{
+
+const double MAX_ERROR = 9.8e-8;
+const double STEP = 1.0 / (1 << 16);
+
+int failures = 0;
+
+
+double reference(float x)
+{
+    return 1.0 / (1.0 + std::exp(-4.9 * static_cast<double>(x)));
+}
+
+
+void check(float x, double& max_error)
+{
+    float value = tank::fast_sigmoid(x);
+    double error = std::fabs(value - reference(x));
+    max_error = std::fmax(max_error, error);
+    if(!(error <= MAX_ERROR) && failures++ < 10)
+    {
+        std::cerr << "fast_sigmoid(" << x << ") = " << value << ", off by " << error << std::endl;
+    }
+
+    if(tank::activation_function(x) != value && failures++ < 10)
+    {
+        std::cerr << "activation_function(" << x << ") differs from fast_sigmoid" << std::endl;
+    }
+}
+
+
+#if defined(__SSE2__)
+
+/**
+ * Compares the vector versions against the scalar one, lane by lane.
+ */
+void check_simd(const float* x)
+{
+    float scalar[8];
+    for(int i = 0; i < 8; ++i)
+    {
+        scalar[i] = tank::fast_sigmoid(x[i]);
+    }
+
+    float sse[8];
+    _mm_storeu_ps(sse, tank::fast_sigmoid(_mm_loadu_ps(x)));
+    _mm_storeu_ps(sse + 4, tank::fast_sigmoid(_mm_loadu_ps(x + 4)));
+    if(std::memcmp(scalar, sse, sizeof(scalar)) != 0 && failures++ < 10)
+    {
+        std::cerr << "SSE2 fast_sigmoid differs from the scalar one around " << x[0] << std::endl;
+    }
+
+#if defined(__AVX2__)
+    float avx[8];
+    _mm256_storeu_ps(avx, tank::fast_sigmoid(_mm256_loadu_ps(x)));
+    if(std::memcmp(scalar, avx, sizeof(scalar)) != 0 && failures++ < 10)
+    {
+        std::cerr << "AVX2 fast_sigmoid differs from the scalar one around " << x[0] << std::endl;
+    }
+#endif
+}
+
+#endif
+
+}
+
+
+int main()
+{
+    double max_error = 0.0;
+
+    float lanes[8];
+    int lane = 0;
+    for(long step = -(20L << 16); step <= 20L << 16; ++step)
+    {
+        float x = static_cast<float>(step * STEP);
+        check(x, max_error);
+
+#if defined(__SSE2__)
+        lanes[lane++] = x;
+        if(lane == 8)
+        {
+            check_simd(lanes);
+            lane = 0;
+        }
+#endif
+    }
+
+    const float extremes[] = {-std::numeric_limits<float>::max(), -1000.0f, -100.0f, -17.8f, 17.8f, 100.0f, 1000.0f,
+                              std::numeric_limits<float>::max()};
+    for(float x : extremes)
+    {
+        check(x, max_error);
+    }
+#if defined(__SSE2__)
+    check_simd(extremes);
+#endif
+
+    std::cout << "Maximum error " << max_error << std::endl;
+    if(failures > 0)
+    {
+        std::cerr << failures << " failures" << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
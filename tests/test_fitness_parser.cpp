@@ -0,0 +1,114 @@
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "fitness_parser.h"
+
+
+/**
+ * Checks what parse_fitnesses accepts and what it refuses, the edge cases of JSON numbers and arrays included.
+ */
+
+namespace
+{
+
+int failures = 0;
+
+
+std::vector<double> parse(const std::string& body)
+{
+    std::vector<double> fitnesses;
+    tank::parse_fitnesses(body.data(), body.data() + body.size(), fitnesses);
+    return fitnesses;
+}
+
+
+void accepts(const std::string& body, const std::vector<double>& expected)
+{
+    try
+    {
+        auto fitnesses = parse(body);
+        if(fitnesses != expected)
+        {
+            std::cerr << "Wrong fitnesses parsed from " << body << std::endl;
+            ++failures;
+        }
+    }
+    catch(const std::invalid_argument& e)
+    {
+        std::cerr << "Refused " << body << ": " << e.what() << std::endl;
+        ++failures;
+    }
+}
+
+
+void refuses(const std::string& body)
+{
+    try
+    {
+        parse(body);
+        std::cerr << "Accepted " << body << std::endl;
+        ++failures;
+    }
+    catch(const std::invalid_argument&)
+    {
+    }
+}
+
+}
+
+
+int main()
+{
+    accepts("[]", {});
+    accepts(" [ ] ", {});
+    accepts("[0]", {0.0});
+    accepts("[-0]", {-0.0});
+    accepts("[1,2,3]", {1.0, 2.0, 3.0});
+    accepts("\t[ 1 ,\r\n 2 ]\n", {1.0, 2.0});
+    accepts("[12.5,-3.25,1e3,2E-2,0.5e+1]", {12.5, -3.25, 1000.0, 0.02, 5.0});
+    accepts("[123456789012345]", {123456789012345.0});
+
+    // more digits than a double holds exactly, or than a 64 bit integer holds at all
+    accepts("[1234567890123456789]", {1234567890123456789.0});
+    accepts("[123456789012345678901234567890]", {123456789012345678901234567890.0});
+
+    // the longest number taken, and one digit more
+    std::string longest = "0." + std::string(62, '1');
+    accepts("[" + longest + "]", {std::strtod(longest.c_str(), nullptr)});
+    refuses("[" + longest + "1]");
+
+    refuses("");
+    refuses("[");
+    refuses("]");
+    refuses("[1,]");
+    refuses("[,1]");
+    refuses("[1 2]");
+    refuses("[01]");
+    refuses("[-01]");
+    refuses("[00]");
+    refuses("[+1]");
+    refuses("[.5]");
+    refuses("[1.]");
+    refuses("[1e]");
+    refuses("[1e+]");
+    refuses("[-]");
+    refuses("[1]x");
+    refuses("[1] [2]");
+    refuses("[\"1\"]");
+    refuses("[null]");
+    refuses("{}");
+
+    // valid JSON, but not a finite fitness
+    refuses("[1e999]");
+    refuses("[-1e999]");
+
+    if(failures > 0)
+    {
+        std::cerr << failures << " failures" << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
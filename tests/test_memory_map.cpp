@@ -0,0 +1,134 @@
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <random>
+#include <utility>
+
+#include "consts.h"
+#include "memory_map.h"
+
+
+/**
+ * Checks the visited count and the ticks of MemoryMap against a plain map of cells, across resets, and that ticks
+ * stop at MAX_TICK instead of wrapping around the byte they are kept in.
+ */
+
+namespace
+{
+
+const float WIDTH = 1900.0f;
+const float HEIGHT = 800.0f;
+
+int failures = 0;
+
+
+void check(bool condition, const char* what)
+{
+    if(!condition && failures++ < 10)
+    {
+        std::cerr << "FAILED: " << what << std::endl;
+    }
+}
+
+
+/**
+ * What Map in web/app/map.js keeps, one entry per cell ever entered.
+ */
+struct ReferenceMap
+{
+    std::map<std::pair<int, int>, int> ticks;
+
+    void update(float x, float y)
+    {
+        if(x >= 0 && x <= WIDTH && y >= 0 && y <= HEIGHT)
+        {
+            auto& cell = ticks[{static_cast<int>(x / tank::CELL_SIZE), static_cast<int>(y / tank::CELL_SIZE)}];
+            cell = std::min(cell + tank::TICK_INCREMENT, tank::MAX_TICK);
+        }
+    }
+
+    int ticks_lingered(float x, float y) const
+    {
+        if(!(x >= 0 && x <= WIDTH && y >= 0 && y <= HEIGHT))
+        {
+            return tank::MAX_TICK;
+        }
+        auto it = ticks.find({static_cast<int>(x / tank::CELL_SIZE), static_cast<int>(y / tank::CELL_SIZE)});
+        return it != ticks.end() ? it->second : 0;
+    }
+};
+
+}
+
+
+int main()
+{
+    tank::MemoryMap map(WIDTH, HEIGHT, tank::CELL_SIZE);
+    check(map.get_num_cells_visited() == 0, "a new map has no cell visited");
+    check(map.ticks_lingered(10.0f, 10.0f) == 0, "a new map has no ticks");
+    check(map.ticks_lingered(-1.0f, 10.0f) == tank::MAX_TICK, "outside of the map counts as fully lingered");
+
+    // far more updates than a byte holds, the ticks have to stop at MAX_TICK and the cell count once
+    for(int i = 0; i < 1000; ++i)
+    {
+        map.update(10.0f, 10.0f);
+        if(i == 0)
+        {
+            check(map.ticks_lingered(10.0f, 10.0f) == tank::TICK_INCREMENT, "the first visit adds one increment");
+        }
+    }
+    check(map.ticks_lingered(10.0f, 10.0f) == tank::MAX_TICK, "ticks stop at MAX_TICK");
+    check(map.get_num_cells_visited() == 1, "lingering in a cell counts it once");
+
+    // the far edges belong to the map, positions past them do not
+    map.update(WIDTH, HEIGHT);
+    map.update(WIDTH + 1.0f, 10.0f);
+    map.update(10.0f, -0.5f);
+    check(map.get_num_cells_visited() == 2, "the far corner is a cell, positions outside of the map are not");
+
+    map.reset();
+    check(map.get_num_cells_visited() == 0, "reset clears the count");
+    check(map.ticks_lingered(10.0f, 10.0f) == 0 && map.ticks_lingered(WIDTH, HEIGHT) == 0, "reset clears the ticks");
+
+    // every cell once
+    int num_cells = 0;
+    for(float x = 0.0f; x <= WIDTH; x += tank::CELL_SIZE)
+    {
+        for(float y = 0.0f; y <= HEIGHT; y += tank::CELL_SIZE)
+        {
+            map.update(x + 0.5f * tank::CELL_SIZE, y);
+            ++num_cells;
+        }
+    }
+    check(map.get_num_cells_visited() == num_cells, "every cell of the map counts");
+
+    // random walks in and out of the map, with resets in between as between generations
+    std::mt19937 random(97531);
+    std::uniform_real_distribution<float> step(-30.0f, 30.0f);
+    for(int walk = 0; walk < 20; ++walk)
+    {
+        map.reset();
+        ReferenceMap reference;
+        float x = WIDTH / 2;
+        float y = HEIGHT / 2;
+        for(int frame = 0; frame < 5000; ++frame)
+        {
+            x = std::min(std::max(x + step(random), -50.0f), WIDTH + 50.0f);
+            y = std::min(std::max(y + step(random), -50.0f), HEIGHT + 50.0f);
+            map.update(x, y);
+            reference.update(x, y);
+
+            check(map.ticks_lingered(x, y) == reference.ticks_lingered(x, y), "ticks match the reference");
+            check(map.get_num_cells_visited() == static_cast<int>(reference.ticks.size()),
+                  "the visited count matches the reference");
+        }
+    }
+
+    if(failures > 0)
+    {
+        std::cerr << failures << " failures" << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
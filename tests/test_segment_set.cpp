@@ -0,0 +1,229 @@
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "segment_grid.h"
+#include "segment_set.h"
+#include "world.h"
+
+
+/**
+ * Casts random rays against random obstacles and checks that SegmentSet, the cells of SegmentGrid and World all
+ * find exactly the hits line_intersection_2d finds against every segment. Origins include points on cell borders
+ * and points off the grid, and rays run up to the grid's reach plus part of the margin it keeps for rounding. Rays
+ * leaving a cell at full reach must find a segment just before their end.
+ */
+
+namespace
+{
+
+const float WIDTH = 1900.0f;
+const float HEIGHT = 800.0f;
+const float REACH = tank::SENSOR_RANGE;
+const int NUM_CASTS = 20000;
+
+int failures = 0;
+
+
+/**
+ * Triangles and quads of all sizes, some with axis aligned edges like the walls of the default world.
+ */
+std::vector<tank::Polygon> random_obstacles(std::mt19937& random)
+{
+    std::uniform_real_distribution<float> x(-50.0f, WIDTH + 50.0f);
+    std::uniform_real_distribution<float> y(-50.0f, HEIGHT + 50.0f);
+    std::uniform_real_distribution<float> size(1.0f, 250.0f);
+    std::uniform_int_distribution<int> corners(3, 4);
+
+    std::vector<tank::Polygon> obstacles;
+    for(int i = 0; i < 60; ++i)
+    {
+        tank::Vec2 first{x(random), y(random)};
+        tank::Polygon polygon{first};
+        if(i % 3 == 0)
+        {
+            float w = size(random);
+            float h = size(random);
+            polygon.push_back({first.x + w, first.y});
+            polygon.push_back({first.x + w, first.y + h});
+            polygon.push_back({first.x, first.y + h});
+        }
+        else
+        {
+            std::uniform_real_distribution<float> offset(-size(random), size(random));
+            for(int c = corners(random) - 1; c > 0; --c)
+            {
+                polygon.push_back({first.x + offset(random), first.y + offset(random)});
+            }
+        }
+        polygon.push_back(first);
+        obstacles.push_back(polygon);
+    }
+    return obstacles;
+}
+
+
+/**
+ * Nearest hit of the ray from origin to end the slow way, NO_COLLISION if there is none.
+ */
+float reference_depth(const std::vector<tank::Polygon>& obstacles, tank::Vec2 origin, tank::Vec2 end)
+{
+    float nearest = tank::NO_COLLISION;
+    for(auto& polygon : obstacles)
+    {
+        for(std::size_t i = 0; i + 1 < polygon.size(); ++i)
+        {
+            float depth = tank::line_intersection_2d(origin, end, polygon[i], polygon[i + 1]);
+            if(depth != tank::NO_COLLISION && (nearest == tank::NO_COLLISION || depth < nearest))
+            {
+                nearest = depth;
+            }
+        }
+    }
+    return nearest;
+}
+
+
+/**
+ * Casts from the lower left corner of cells straight out of them, at a short segment across the ray just before its
+ * end. The cell must list the segment, or the grid's margin is too thin.
+ */
+void check_margin(std::mt19937& random)
+{
+    std::uniform_int_distribution<int> cell_x(1, static_cast<int>(WIDTH) / tank::CELL_SIZE);
+    std::uniform_int_distribution<int> cell_y(1, static_cast<int>(HEIGHT) / tank::CELL_SIZE);
+    std::uniform_real_distribution<float> jitter(-0.3f, 0.3f);
+    std::uniform_real_distribution<float> before_end(0.01f, 0.5f);
+
+    for(int i = 0; i < 2000; ++i)
+    {
+        tank::Vec2 origin{static_cast<float>(cell_x(random) * tank::CELL_SIZE),
+                          static_cast<float>(cell_y(random) * tank::CELL_SIZE)};
+        float a = (i % 2 == 0 ? tank::PI : 1.5f * tank::PI) + jitter(random);
+        tank::Vec2 direction{std::cos(a), std::sin(a)};
+
+        float distance = REACH - before_end(random);
+        tank::Vec2 middle{origin.x + distance * direction.x, origin.y + distance * direction.y};
+        tank::Polygon segment = {{middle.x - direction.y, middle.y + direction.x},
+                                 {middle.x + direction.y, middle.y - direction.x}};
+
+        tank::SensorArray ends;
+        ends.fill({origin.x + REACH * direction.x, origin.y + REACH * direction.y});
+        tank::SensorDepths expected;
+        expected.fill(reference_depth({segment}, origin, ends[0]));
+
+        tank::SegmentGrid grid({segment}, WIDTH, HEIGHT, tank::CELL_SIZE, REACH);
+        tank::SensorDepths depths;
+        grid.query(origin)->cast(origin, ends, depths);
+        if((expected[0] == tank::NO_COLLISION || depths != expected) && failures++ < 10)
+        {
+            std::cerr << "Grid cell at " << origin.x << ", " << origin.y << " misses a segment " << distance
+                      << " away" << std::endl;
+        }
+    }
+}
+
+
+void compare(const char* what, const tank::SensorDepths& depths, const tank::SensorDepths& expected,
+             tank::Vec2 origin)
+{
+    if(depths != expected && failures++ < 10)
+    {
+        std::cerr << what << " differs from line_intersection_2d at " << origin.x << ", " << origin.y << std::endl;
+    }
+}
+
+}
+
+
+int main()
+{
+    std::mt19937 random(2468);
+    auto obstacles = random_obstacles(random);
+
+    tank::SegmentSet segments(obstacles);
+    tank::SegmentGrid grid(obstacles, WIDTH, HEIGHT, tank::CELL_SIZE, REACH);
+    tank::World world(WIDTH, HEIGHT, obstacles);
+
+    std::uniform_real_distribution<float> x(-100.0f, WIDTH + 100.0f);
+    std::uniform_real_distribution<float> y(-100.0f, HEIGHT + 100.0f);
+    std::uniform_int_distribution<int> cell_x(0, static_cast<int>(WIDTH) / tank::CELL_SIZE);
+    std::uniform_int_distribution<int> cell_y(0, static_cast<int>(HEIGHT) / tank::CELL_SIZE);
+    std::uniform_real_distribution<float> angle(0.0f, 2 * tank::PI);
+    std::uniform_real_distribution<float> length(0.0f, REACH + 0.5f);
+
+    int hits = 0;
+    int off_grid = 0;
+    for(int cast = 0; cast < NUM_CASTS; ++cast)
+    {
+        // every fourth origin sits on a cell border, where a rounding slip would pick the wrong cell
+        tank::Vec2 origin{x(random), y(random)};
+        if(cast % 4 == 0)
+        {
+            origin.x = static_cast<float>(cell_x(random) * tank::CELL_SIZE);
+        }
+        if(cast % 8 == 0)
+        {
+            origin.y = static_cast<float>(cell_y(random) * tank::CELL_SIZE);
+        }
+
+        // the last sensor always reaches as far as the grid promises, the others anywhere up to the margin
+        tank::SensorArray ends;
+        tank::SensorDepths expected;
+        for(int s = 0; s < tank::NUM_SENSORS; ++s)
+        {
+            float a = angle(random);
+            float l = s + 1 == tank::NUM_SENSORS ? REACH : length(random);
+            ends[s] = {origin.x + l * std::cos(a), origin.y + l * std::sin(a)};
+            expected[s] = reference_depth(obstacles, origin, ends[s]);
+            hits += expected[s] != tank::NO_COLLISION;
+        }
+
+        tank::SensorDepths depths;
+        segments.cast(origin, ends, depths);
+        compare("SegmentSet", depths, expected, origin);
+
+        world.cast_sensors(origin, ends, depths);
+        compare("World", depths, expected, origin);
+
+        auto cell = grid.query(origin);
+        if(origin.x < 0 || origin.y < 0)
+        {
+            ++off_grid;
+            if(cell != nullptr && failures++ < 10)
+            {
+                std::cerr << "Grid has a cell at " << origin.x << ", " << origin.y << std::endl;
+            }
+        }
+        else if(origin.x <= WIDTH && origin.y <= HEIGHT)
+        {
+            if(cell == nullptr)
+            {
+                if(failures++ < 10)
+                {
+                    std::cerr << "Grid has no cell at " << origin.x << ", " << origin.y << std::endl;
+                }
+                continue;
+            }
+            cell->cast(origin, ends, depths);
+            compare("SegmentGrid", depths, expected, origin);
+        }
+    }
+
+    check_margin(random);
+
+    std::cout << hits << " hits, " << off_grid << " casts from off the grid" << std::endl;
+    if(hits == 0 || off_grid == 0)
+    {
+        std::cerr << "The casts do not cover hits and origins off the grid" << std::endl;
+        ++failures;
+    }
+    if(failures > 0)
+    {
+        std::cerr << failures << " failures" << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,116 @@
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "random_network.h"
+#include "simulation.h"
+
+
+/**
+ * Checks that the native simulation scores a network the same every time: a network without links always drives
+ * the same path, and a population of random networks gets the same fitnesses run after run and whatever the number
+ * of threads evaluating it, and with it the size of the groups evaluated together.
+ */
+
+namespace
+{
+
+// cells visited in the default world by a bot running both tracks at sigmoid(0) for the default number of frames
+const double UNLINKED_FITNESS = 4.0;
+
+const unsigned SEED = 1234;
+
+int failures = 0;
+
+
+void check(bool condition, const char* what)
+{
+    if(!condition)
+    {
+        std::cerr << "FAILED: " << what << std::endl;
+        ++failures;
+    }
+}
+
+
+/**
+ * Inputs, bias and outputs without a single link, so both tracks always get sigmoid(0).
+ */
+tank::NetworkDescription unlinked_network()
+{
+    tank::NetworkDescription network;
+    int id = 1;
+    for(int i = 0; i < tank::NUM_INPUTS; ++i)
+    {
+        network.push_back({id++, tank::NeuronType::INPUT, 1.0, {}});
+    }
+    network.push_back({id++, tank::NeuronType::BIAS, 1.0, {}});
+    for(int i = 0; i < tank::NUM_OUTPUTS; ++i)
+    {
+        network.push_back({id++, tank::NeuronType::OUTPUT, 1.0, {}});
+    }
+    return network;
+}
+
+}
+
+
+int main()
+{
+    tank::TaskPool single(1);
+    tank::TaskPool several(4);
+    tank::TaskPool many(16);
+    tank::Simulation serial(tank::World::default_world(), single);
+    tank::Simulation parallel(tank::World::default_world(), several);
+    tank::Simulation split(tank::World::default_world(), many);
+
+    auto unlinked = unlinked_network();
+    double fitness = serial.evaluate(unlinked);
+    std::cout << "Network without links visits " << fitness << " cells" << std::endl;
+    check(fitness == UNLINKED_FITNESS, "a network without links scores as it always did");
+    check(parallel.evaluate(std::vector<tank::NetworkDescription>(3, unlinked)) ==
+          std::vector<double>(3, UNLINKED_FITNESS), "the batched path drives the same");
+
+    std::mt19937 random(SEED);
+    std::vector<tank::NetworkDescription> networks;
+    for(int i = 0; i < 37; ++i)
+    {
+        networks.push_back(tank::random_network(random));
+    }
+
+    auto expected = serial.evaluate(networks);
+    check(serial.evaluate(networks) == expected, "a second run scores the same");
+    check(parallel.evaluate(networks) == expected, "four threads score the same as one");
+    check(split.evaluate(networks) == expected, "groups smaller than the SIMD width score the same");
+
+    bool scalar_matches = true;
+    for(std::size_t i = 0; i < networks.size(); ++i)
+    {
+        scalar_matches = scalar_matches && serial.evaluate(networks[i]) == expected[i];
+    }
+    check(scalar_matches, "the scalar Brain scores every network like the batched one");
+
+    std::mt19937 same_seed(SEED);
+    std::vector<tank::NetworkDescription> regenerated;
+    for(int i = 0; i < 37; ++i)
+    {
+        regenerated.push_back(tank::random_network(same_seed));
+    }
+    check(parallel.evaluate(regenerated) == expected, "the same seed gives the same population and fitnesses");
+
+    double best = 0.0;
+    for(double f : expected)
+    {
+        best = std::max(best, f);
+    }
+    check(best > 0.0, "some random network gets anywhere");
+
+    if(failures > 0)
+    {
+        std::cerr << failures << " failures" << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,100 @@
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "task_pool.h"
+
+
+/**
+ * Checks that parallel_for runs every index exactly once, rethrows what a task throws, and that idle workers steal
+ * from a queue that was handed only slow tasks.
+ */
+
+namespace
+{
+
+const unsigned NUM_THREADS = 4;
+
+int failures = 0;
+
+
+void check(bool condition, const char* what)
+{
+    if(!condition)
+    {
+        std::cerr << "FAILED: " << what << std::endl;
+        ++failures;
+    }
+}
+
+}
+
+
+int main()
+{
+    tank::TaskPool pool(NUM_THREADS);
+    check(pool.size() == NUM_THREADS, "the pool has the threads asked for");
+
+    // every index once, over and over so the pool is reused between batches
+    for(std::size_t count : {0, 1, 3, 4, 5, 1000})
+    {
+        std::vector<std::atomic<int>> runs(count);
+        for(auto& run : runs)
+        {
+            run = 0;
+        }
+        pool.parallel_for(count, [&runs](std::size_t i) { ++runs[i]; });
+
+        bool once = true;
+        for(auto& run : runs)
+        {
+            once = once && run == 1;
+        }
+        check(once, "every index runs exactly once");
+    }
+
+    try
+    {
+        pool.parallel_for(100, [](std::size_t i)
+        {
+            if(i == 42)
+            {
+                throw std::runtime_error("task failed");
+            }
+        });
+        check(false, "an exception in a task reaches the caller");
+    }
+    catch(const std::runtime_error&)
+    {
+    }
+
+    // The first queue gets the indices [0, 16) up front, all of them slow, the other queues only quick ones. Without
+    // stealing only its own worker and the calling thread would get through them.
+    const std::size_t COUNT = 16 * NUM_THREADS;
+    std::mutex mutex;
+    std::set<std::thread::id> slow_threads;
+    pool.parallel_for(COUNT, [&mutex, &slow_threads](std::size_t i)
+    {
+        if(i < COUNT / NUM_THREADS)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            std::lock_guard<std::mutex> lock(mutex);
+            slow_threads.insert(std::this_thread::get_id());
+        }
+    });
+    std::cout << "Slow tasks ran on " << slow_threads.size() << " threads" << std::endl;
+    check(slow_threads.size() > 2, "idle workers steal slow tasks from another queue");
+
+    if(failures > 0)
+    {
+        std::cerr << failures << " failures" << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,117 @@
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "network_cache.h"
+#include "wire_format.h"
+
+
+/**
+ * Writes a generation, the next one whole and the next one as a delta against the first for test_wire_format.js to
+ * decode with web/app/wire.js and compare. The next generation has a network for every way a delta can send one:
+ * unchanged neurons (KEEP), changed weights and activation responses (PATCH), a new neuron and a rewired one (FULL),
+ * and a network sharing nothing with the base that is sent whole.
+ */
+
+namespace
+{
+
+tank::NeuronDescription make_neuron(int id, tank::NeuronType type, double activation_response,
+                                    const std::vector<std::pair<int, double>>& inputs)
+{
+    tank::NeuronDescription neuron{id, type, activation_response, {}};
+    for(auto& input : inputs)
+    {
+        neuron.in_links.push_back(tank::LinkDescription{input.first, id, input.second});
+    }
+    return neuron;
+}
+
+
+/**
+ * Two inputs and a bias feeding one output, ids starting at first_id.
+ */
+tank::NetworkDescription make_network(int first_id, double weight)
+{
+    return {make_neuron(first_id, tank::NeuronType::INPUT, 1.0, {}),
+            make_neuron(first_id + 1, tank::NeuronType::INPUT, 1.0, {}),
+            make_neuron(first_id + 2, tank::NeuronType::BIAS, 1.0, {}),
+            make_neuron(first_id + 3, tank::NeuronType::OUTPUT, 1.0,
+                        {{first_id, weight}, {first_id + 1, -weight}, {first_id + 2, 0.125}})};
+}
+
+
+bool write_file(const std::string& path, const std::string& data)
+{
+    std::ofstream ofs(path, std::ios::binary);
+    ofs.write(data.data(), data.size());
+    if(!ofs)
+    {
+        std::cerr << "Could not write " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+}
+
+
+int main()
+{
+    const int BASE_GENERATION = 7;
+
+    std::vector<tank::NetworkDescription> base = {make_network(1, 0.5), make_network(1, -0.75)};
+    base[1].insert(base[1].end() - 1, make_neuron(20, tank::NeuronType::HIDDEN, 1.0, {{1, 0.25}}));
+    base[1].back().in_links.push_back(tank::LinkDescription{20, 4, 1.5});
+
+    std::vector<tank::NetworkDescription> next;
+
+    // KEEP only
+    next.push_back(base[0]);
+
+    // PATCH: a weight and an activation response change, the wiring stays
+    next.push_back(base[1]);
+    next.back()[1].activation_response = 2.0;
+    next.back().back().in_links[0].weight = 0.375;
+
+    // FULL: a new hidden neuron, and the output rewired to read it
+    next.push_back(base[0]);
+    next.back().insert(next.back().end() - 1, make_neuron(30, tank::NeuronType::HIDDEN, 0.5, {{2, -1.25}}));
+    next.back().back().in_links.push_back(tank::LinkDescription{30, 4, 0.0625});
+
+    // no neuron in common with the base, sent whole
+    next.push_back(make_network(100, 0.25));
+
+    tank::GenerationSummary base_summary;
+    base_summary.generation = BASE_GENERATION;
+
+    tank::GenerationSummary summary;
+    summary.generation = BASE_GENERATION + 1;
+    summary.best_species_id = 3;
+    summary.best_so_far = 42.5;
+    summary.stats_mean = 2.5;
+    summary.stats_max = 4.0;
+    summary.species = {{3, 10.0}, {-1, 2.0}};
+
+    tank::NetworkCache cache;
+    std::string base_message;
+    tank::encode_generation(base_summary, cache.get(base, BASE_GENERATION), base_message);
+
+    std::string full_message;
+    tank::encode_generation(summary, cache.get(next, BASE_GENERATION + 1), full_message);
+
+    std::string delta_message;
+    tank::encode_generation_delta(summary, next, BASE_GENERATION, base, delta_message);
+
+    if(!write_file("wire_base.bin", base_message) || !write_file("wire_full.bin", full_message) ||
+       !write_file("wire_delta.bin", delta_message))
+    {
+        return EXIT_FAILURE;
+    }
+
+    std::cout << "Full " << full_message.size() << " bytes, delta " << delta_message.size() << " bytes"
+              << std::endl;
+    return EXIT_SUCCESS;
+}
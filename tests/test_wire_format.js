@@ -0,0 +1,67 @@
+'use strict';
+/**
+ * Decodes the messages test_wire_format leaves in the working directory with web/app/wire.js, given as the first
+ * argument, and checks that the delta applied to its base comes out exactly like the full encoding of the same
+ * generation. A delta without its base has to be refused.
+ */
+const fs = require('fs');
+
+var wire = null;
+global.define = function(dependencies, factory)
+{
+    wire = factory();
+};
+eval(fs.readFileSync(process.argv[2], 'utf8'));
+
+function read_message(path)
+{
+    var bytes = fs.readFileSync(path);
+    return bytes.buffer.slice(bytes.byteOffset, bytes.byteOffset + bytes.length);
+}
+
+var failures = 0;
+
+function check(condition, what)
+{
+    if(!condition)
+    {
+        console.error("FAILED: " + what);
+        ++failures;
+    }
+}
+
+var base = wire.decode(read_message("wire_base.bin"), null);
+var full = wire.decode(read_message("wire_full.bin"), null);
+
+// brains annotate the neurons they run on, none of that may leak into the networks built from them
+for(let network of base.brains)
+{
+    for(let neuron of network)
+    {
+        neuron.OutputSignal = 0.5;
+    }
+}
+
+var delta = wire.decode(read_message("wire_delta.bin"), base);
+check(JSON.stringify(delta) === JSON.stringify(full), "the delta decodes to the full generation");
+check(delta.generation === full.generation, "the delta has the generation of the full message");
+check(delta.brains.length === 4, "every network of the generation is in the delta");
+
+for(let stale_base of [null, full])
+{
+    try
+    {
+        wire.decode(read_message("wire_delta.bin"), stale_base);
+        check(false, "a delta without its base is refused");
+    }
+    catch(error)
+    {
+        check(error instanceof wire.StaleBaseError, "a delta without its base throws a StaleBaseError");
+    }
+}
+
+if(failures > 0)
+{
+    process.exit(1);
+}
+console.log("Delta matches the full encoding");
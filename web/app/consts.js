@@ -12,6 +12,7 @@ define([], function()
     var EPOCH_INTERVAL = 40;
     var BOT_START_POSITION = [400, 400];
     var FAST_MODE_FRAMES_PER_EPOCH = 2000;
+    var RECONNECT_INTERVAL = 2;
 
     return {
         MAX_ROTATION: MAX_ROTATION,
@@ -24,6 +25,7 @@ define([], function()
         BOT_START_POSITION: BOT_START_POSITION,
         FAST_MODE_FRAMES_PER_EPOCH: FAST_MODE_FRAMES_PER_EPOCH,
         FPS: FPS,
-        COLLISION_THRESHOLD: COLLISION_THRESHOLD
+        COLLISION_THRESHOLD: COLLISION_THRESHOLD,
+        RECONNECT_INTERVAL: RECONNECT_INTERVAL
     }
 });
@@ -1,11 +1,38 @@
-define(['jquery', 'underscore', './bot', './map', './obstacles', './consts', './brain', './graphics'], function($, _, bot, map, obstacles, consts, brain, graphics)
+define(['jquery', 'underscore', './bot', './map', './obstacles', './consts', './brain', './graphics', './observer', './wire'], function($, _, bot, map, obstacles, consts, brain, graphics, observer, wire)
 {
+    /**
+     * Requests networks from the server in the binary wire format and resolves with the decoded message. Given the
+     * last message received, the server may answer with just the changes to it.
+     */
+    function fetch_networks(url, options, base)
+    {
+        options.headers = {"Accept": wire.CONTENT_TYPE};
+        if(base)
+        {
+            options.headers["X-Base-Generation"] = base.generation;
+        }
+
+        return fetch(url, options).then(function(response)
+        {
+            if(!response.ok)
+            {
+                throw new Error(response.status + " " + response.statusText);
+            }
+            return response.arrayBuffer();
+        }).then(function(buffer)
+        {
+            return wire.decode(buffer, base);
+        });
+    }
+
     class Game
     {
-        constructor(canvas_id)
+        constructor(canvas_id, observe, api_root)
         {
             this.canvas = document.getElementById(canvas_id);
-            this.bots = this.initialize_bots();
+            this.observe = observe;
+            this.api_root = api_root || "";
+            this.bots = observe ? [] : this.initialize_bots();
             this.loop_handle = null;
             this.epoch_handle = null;
             this.current_loop = this.loop;
@@ -23,6 +50,18 @@ define(['jquery', 'underscore', './bot', './map', './obstacles', './consts', './
             this.renderer.draw_border();
             this.setup_events();
             this.response = null;
+
+            // last decoded message with brains, what the server sends its deltas against
+            this.networks = null;
+
+            if(observe)
+            {
+                this.observer = new observer.RunObserver({
+                    population: this.brains_received.bind(this),
+                    generation: this.brains_received.bind(this),
+                    image: function(message) { this.renderer.update_resources(); }.bind(this)
+                });
+            }
         }
 
         epoch()
@@ -52,6 +91,20 @@ define(['jquery', 'underscore', './bot', './map', './obstacles', './consts', './
             this.start();
         }
 
+        brains_received(message)
+        {
+            console.log("Generation " + message.generation + " received");
+            this.stop();
+            this.bots = _.map(message.brains, this.create_bot.bind(this));
+            this.renderer.update_resources();
+
+            if(message.type === "generation")
+            {
+                this.response = message;
+            }
+            this.start();
+        }
+
         setup_events()
         {
             document.addEventListener('keydown', this.handle_events.bind(this));
@@ -158,14 +211,22 @@ define(['jquery', 'underscore', './bot', './map', './obstacles', './consts', './
 
         post_fitnesses(fitnesses, completion_cb)
         {
+            // observers wait for the next generation to be pushed
+            if(this.observe)
+            {
+                return;
+            }
+
             console.log(fitnesses);
             var self = this;
-            $.post("fitness", JSON.stringify(fitnesses)).then(
-                function(response, text_status, jqXHR) {
+            var options = {method: "POST", body: JSON.stringify(fitnesses)};
+            fetch_networks(this.api_root + "fitness", options, this.networks).then(
+                function(response) {
+                    self.networks = response;
                     completion_cb(response);
                 },
-                function(response, text_status, jqXHR) {
-                    console.log("Fetching bot brains failed: " + text_status);
+                function(error) {
+                    console.log("Fetching bot brains failed: " + error);
                 }
             );
         }
@@ -180,26 +241,32 @@ define(['jquery', 'underscore', './bot', './map', './obstacles', './consts', './
 //                                    self.canvas.height,
 //                                    consts.CELL_SIZE))];
             var bots = [];
-            $.get("init_brains").then(
-                function(response, text_status, jqXHR)
+            fetch_networks(this.api_root + "init_brains", {method: "GET"}).then(
+                function(response)
                 {
-                    for(let r of response)
+                    self.networks = response;
+                    for(let r of response.brains)
                     {
-                        bots.push(new bot.Bot(1,
-                                  consts.BOT_START_POSITION,
-                                  new brain.BotBrain(r),
-                                  new map.Map(self.canvas.width,
-                                              self.canvas.height,
-                                              consts.CELL_SIZE)));
+                        bots.push(self.create_bot(r));
                     }
                 },
-                function(response, text_status, jqXHR)
+                function(error)
                 {
                     throw "Bot initialization failed.";
                 }
             );
             return bots;
         }
+
+        create_bot(brain_description)
+        {
+            return new bot.Bot(1,
+                               consts.BOT_START_POSITION,
+                               new brain.BotBrain(brain_description),
+                               new map.Map(this.canvas.width,
+                                           this.canvas.height,
+                                           consts.CELL_SIZE));
+        }
     }
 
     return {
@@ -1,5 +1,12 @@
 define(function(require) {
     var game = require('./game');
 
-    var bot_game = new game.Game("sim_canvas");
+    // "?observe" follows a run trained by another client instead of training one
+    var observe = window.location.search.indexOf("observe") !== -1;
+
+    // "?session=<id>" trains the population of that session instead of the default one
+    var session = /[?&]session=([A-Za-z0-9_-]+)/.exec(window.location.search);
+    var api_root = session ? "sessions/" + session[1] + "/" : "";
+
+    var bot_game = new game.Game("sim_canvas", observe, api_root);
 });
@@ -0,0 +1,99 @@
+'use strict';
+define(['underscore', './consts', './wire'], function(_, consts, wire)
+{
+    /**
+     * Follows a run over the server's WebSocket push channel. Networks arrive in the binary wire format, everything
+     * else as JSON. Every message is handed to the handler registered for its type. Lost connections are retried
+     * until the server is back.
+     */
+    class RunObserver
+    {
+        constructor(handlers)
+        {
+            this.handlers = handlers;
+            this.socket = null;
+            this.networks = null;
+            this.connect();
+        }
+
+        /**
+         * Asks the server where its push channel is, it may run on any port or not at all.
+         */
+        connect()
+        {
+            fetch("/status").then(function(response)
+            {
+                if(!response.ok)
+                {
+                    throw new Error(response.status + " " + response.statusText);
+                }
+                return response.json();
+            }).then(function(status)
+            {
+                if(_.isUndefined(status.push_port))
+                {
+                    console.log("The server does not push the run to observers");
+                    return;
+                }
+                this.open("ws://" + window.location.hostname + ":" + status.push_port + "/");
+            }.bind(this)).catch(function(error)
+            {
+                console.log("Could not reach the server: " + error.message);
+                this.reconnect();
+            }.bind(this));
+        }
+
+        reconnect()
+        {
+            setTimeout(this.connect.bind(this), consts.RECONNECT_INTERVAL * 1000);
+        }
+
+        open(url)
+        {
+            console.log("Observing run at " + url);
+            this.socket = new WebSocket(url);
+            this.socket.binaryType = "arraybuffer";
+            this.socket.onmessage = this.handle_message.bind(this);
+            this.socket.onclose = function(event)
+            {
+                console.log("Push channel closed, reconnecting");
+                this.reconnect();
+            }.bind(this);
+        }
+
+        handle_message(event)
+        {
+            var message;
+            if(event.data instanceof ArrayBuffer)
+            {
+                try
+                {
+                    message = wire.decode(event.data, this.networks);
+                }
+                catch(error)
+                {
+                    // missed the generation a delta builds on, a new connection starts from a whole one
+                    console.log(error.message);
+                    this.networks = null;
+                    this.socket.close();
+                    return;
+                }
+                this.networks = message;
+            }
+            else
+            {
+                message = JSON.parse(event.data);
+            }
+
+            var handler = this.handlers[message.type];
+            if(!_.isUndefined(handler))
+            {
+                handler(message);
+            }
+        }
+    }
+
+    return {
+        RunObserver: RunObserver
+    };
+});
@@ -0,0 +1,284 @@
+'use strict';
+define([], function()
+{
+    // Decoder of the binary network encoding, see include/wire_format.h for the layout
+    var CONTENT_TYPE = "application/x-tank-networks";
+    var VERSION = 1;
+    var NEURON_TYPES = ["INPUT", "BIAS", "HIDDEN", "OUTPUT"];
+
+    // WireMessage in wire_format.h, the browser only gets the first three
+    var WireMessage = {
+        POPULATION: 1,
+        GENERATION: 2,
+        GENERATION_DELTA: 3,
+        EVALUATE: 4,
+        FITNESSES: 5
+    };
+    var DELTA_KEEP = 0;
+    var DELTA_PATCH = 1;
+    var DELTA_FULL = 2;
+
+    /**
+     * Fills in the outgoing links of every neuron from the incoming ones.
+     */
+    function link_outputs(neurons)
+    {
+        var by_id = {};
+        for(let neuron of neurons)
+        {
+            by_id[neuron.ID] = neuron;
+        }
+
+        // links travel once, with the neuron they lead into
+        for(let neuron of neurons)
+        {
+            for(let link of neuron.InLinks)
+            {
+                var source = by_id[link.InputID];
+                if(source !== undefined)
+                {
+                    source.OutLinks.push({InputID: link.InputID, OutputID: link.OutputID, Weight: link.Weight});
+                }
+            }
+        }
+        return neurons;
+    }
+
+    /**
+     * Copy of the decoded fields of a neuron, leaving out whatever a brain added to it while running.
+     */
+    function copy_neuron(neuron)
+    {
+        return {
+            Type: neuron.Type,
+            ID: neuron.ID,
+            ActivationResponse: neuron.ActivationResponse,
+            InLinks: neuron.InLinks.map(function(link)
+            {
+                return {InputID: link.InputID, OutputID: link.OutputID, Weight: link.Weight};
+            }),
+            OutLinks: []
+        };
+    }
+
+    class WireReader
+    {
+        constructor(buffer)
+        {
+            this.view = new DataView(buffer);
+            this.offset = 0;
+        }
+
+        u8()
+        {
+            return this.view.getUint8(this.offset++);
+        }
+
+        varint()
+        {
+            var result = 0;
+            var scale = 1;
+            var byte;
+            do
+            {
+                byte = this.u8();
+                result += (byte & 0x7f) * scale;
+                scale *= 128;
+            } while(byte & 0x80);
+            return result;
+        }
+
+        zigzag()
+        {
+            var value = this.varint();
+            return value % 2 === 0 ? value / 2 : -(value + 1) / 2;
+        }
+
+        f32()
+        {
+            var value = this.view.getFloat32(this.offset, true);
+            this.offset += 4;
+            return value;
+        }
+
+        f64()
+        {
+            var value = this.view.getFloat64(this.offset, true);
+            this.offset += 8;
+            return value;
+        }
+
+        networks()
+        {
+            var networks = [];
+            var num_networks = this.varint();
+            for(var n = 0; n < num_networks; ++n)
+            {
+                networks.push(this.network());
+            }
+            return networks;
+        }
+
+        network()
+        {
+            var neurons = [];
+            var num_neurons = this.varint();
+            for(var i = 0; i < num_neurons; ++i)
+            {
+                neurons.push(this.neuron());
+            }
+            return link_outputs(neurons);
+        }
+
+        neuron()
+        {
+            var neuron = {
+                Type: NEURON_TYPES[this.u8()],
+                ID: this.zigzag(),
+                ActivationResponse: this.f32(),
+                InLinks: [],
+                OutLinks: []
+            };
+
+            var num_links = this.varint();
+            for(var l = 0; l < num_links; ++l)
+            {
+                neuron.InLinks.push({InputID: this.zigzag(), OutputID: neuron.ID, Weight: this.f32()});
+            }
+            return neuron;
+        }
+
+        delta_networks(base_networks)
+        {
+            var networks = [];
+            var num_networks = this.varint();
+            for(var n = 0; n < num_networks; ++n)
+            {
+                var base_index = this.varint();
+                if(base_index === 0)
+                {
+                    networks.push(this.network());
+                    continue;
+                }
+
+                var base_neurons = {};
+                for(let neuron of base_networks[base_index - 1])
+                {
+                    base_neurons[neuron.ID] = neuron;
+                }
+
+                var neurons = [];
+                var num_neurons = this.varint();
+                for(var i = 0; i < num_neurons; ++i)
+                {
+                    var op = this.u8();
+                    if(op === DELTA_FULL)
+                    {
+                        neurons.push(this.neuron());
+                        continue;
+                    }
+
+                    var neuron = copy_neuron(base_neurons[this.zigzag()]);
+                    if(op === DELTA_PATCH)
+                    {
+                        neuron.ActivationResponse = this.f32();
+                        var num_changes = this.varint();
+                        for(var c = 0; c < num_changes; ++c)
+                        {
+                            var link = neuron.InLinks[this.varint()];
+                            link.Weight = this.f32();
+                        }
+                    }
+                    neurons.push(neuron);
+                }
+                networks.push(link_outputs(neurons));
+            }
+            return networks;
+        }
+
+        summary()
+        {
+            var message = {
+                type: "generation",
+                generation: this.varint(),
+                best_specie_id: this.zigzag(),
+                best_so_far: this.f64(),
+                species_stats: {
+                    mean: this.f64(),
+                    std: this.f64(),
+                    min: this.f64(),
+                    max: this.f64(),
+                    current: this.f64()
+                },
+                species: {}
+            };
+
+            var num_species = this.varint();
+            for(var s = 0; s < num_species; ++s)
+            {
+                var id = this.zigzag();
+                message.species[id] = this.f64();
+            }
+            return message;
+        }
+    }
+
+    class StaleBaseError extends Error
+    {
+        constructor(base_generation)
+        {
+            super("Delta needs generation " + base_generation + " as its base");
+            this.base_generation = base_generation;
+        }
+    }
+
+    /**
+     * Decodes a binary message into the same shape the JSON responses have. Deltas are applied to base, the last
+     * decoded message holding brains, and throw a StaleBaseError if it is not the generation they are based on.
+     */
+    function decode(buffer, base)
+    {
+        var reader = new WireReader(buffer);
+        var magic = String.fromCharCode(reader.u8(), reader.u8(), reader.u8());
+        var version = reader.u8();
+        if(magic !== "TNK" || version !== VERSION)
+        {
+            throw new Error("Unsupported network encoding: " + magic + " version " + version);
+        }
+
+        var kind = reader.u8();
+        if(kind === WireMessage.POPULATION)
+        {
+            return {
+                type: "population",
+                generation: reader.varint(),
+                brains: reader.networks()
+            };
+        }
+        else if(kind === WireMessage.GENERATION)
+        {
+            var message = reader.summary();
+            message.brains = reader.networks();
+            return message;
+        }
+        else if(kind === WireMessage.GENERATION_DELTA)
+        {
+            var delta = reader.summary();
+            var base_generation = reader.varint();
+            if(!base || base.generation !== base_generation)
+            {
+                throw new StaleBaseError(base_generation);
+            }
+            delta.brains = reader.delta_networks(base.brains);
+            return delta;
+        }
+        throw new Error("Unknown network message kind " + kind);
+    }
+
+    return {
+        CONTENT_TYPE: CONTENT_TYPE,
+        WireMessage: WireMessage,
+        StaleBaseError: StaleBaseError,
+        decode: decode
+    };
+});